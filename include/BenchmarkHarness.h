@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CycleClock.h"
+#include "PerfCounters.h"
+
+// Minimal benchmarking toolkit shared by the benchmark binaries: a
+// per-operation latency recorder over CycleClock with percentile summaries,
+// and JSON output so runs from different builds can be diffed.
+
+// Keeps the compiler from discarding work whose result is otherwise unused.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct BenchmarkResult {
+    std::string name;
+    std::size_t operations = 0;
+    double seconds = 0.0;
+    double opsPerSecond = 0.0;
+    double meanNs = 0.0;
+    double p50Ns = 0.0;
+    double p99Ns = 0.0;
+    double p999Ns = 0.0;
+    double maxNs = 0.0;
+    std::vector<std::pair<std::string, double>> countersPerOp;  // empty unless counters were captured
+};
+
+// Brackets a measured loop with hardware counters when perf is non-null:
+// construct before the loop, stop() right after it, then attach() once the
+// result (and its operation count) exists. stop()/resume() around untimed
+// setup keep it out of the counts. Counts include the per-op cycle
+// counter reads, which are a small constant next to the book operations.
+class CounterRegion {
+public:
+    explicit CounterRegion(PerfCounters* perf) : perf_(perf) {
+        if (perf_) perf_->start();
+    }
+
+    void stop() {
+        if (perf_) perf_->stop();
+    }
+
+    void resume() {
+        if (perf_) perf_->resume();
+    }
+
+    BenchmarkResult attach(BenchmarkResult result) const {
+        if (perf_) result.countersPerOp = perf_->perOperation(result.operations);
+        return result;
+    }
+
+private:
+    PerfCounters* perf_;
+};
+
+// Collects one cycle count per operation. Storage is reserved up front so
+// recording never allocates inside a measured loop.
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(std::size_t expectedOperations) {
+        samples_.reserve(expectedOperations);
+    }
+
+    void record(std::uint64_t cycles) {
+        samples_.push_back(cycles);
+    }
+
+    std::size_t size() const {
+        return samples_.size();
+    }
+
+    BenchmarkResult summarize(const std::string& name) {
+        BenchmarkResult result;
+        result.name = name;
+        result.operations = samples_.size();
+        if (samples_.empty()) {
+            return result;
+        }
+
+        std::sort(samples_.begin(), samples_.end());
+        double perNs = cyclesPerNanosecond();
+        double totalCycles = 0.0;
+        for (std::uint64_t sample : samples_) {
+            totalCycles += sample;
+        }
+        auto percentile = [&](double p) {
+            std::size_t index = static_cast<std::size_t>(p * (samples_.size() - 1));
+            return samples_[index] / perNs;
+        };
+
+        result.seconds = totalCycles / perNs / 1e9;
+        result.opsPerSecond = result.seconds > 0.0 ? samples_.size() / result.seconds : 0.0;
+        result.meanNs = totalCycles / samples_.size() / perNs;
+        result.p50Ns = percentile(0.50);
+        result.p99Ns = percentile(0.99);
+        result.p999Ns = percentile(0.999);
+        result.maxNs = samples_.back() / perNs;
+        return result;
+    }
+
+private:
+    std::vector<std::uint64_t> samples_;
+};
+
+inline void printResultHeader() {
+    std::cout << std::left << std::setw(28) << "benchmark" << std::right
+              << std::setw(10) << "ops" << std::setw(14) << "ops/s"
+              << std::setw(10) << "mean ns" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+              << std::setw(11) << "p99.9 ns" << std::setw(12) << "max ns" << std::endl;
+}
+
+inline void printResult(const BenchmarkResult& result) {
+    std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << result.operations << std::setw(14) << result.opsPerSecond
+              << std::setw(10) << result.meanNs << std::setw(10) << result.p50Ns << std::setw(10) << result.p99Ns
+              << std::setw(11) << result.p999Ns << std::setw(12) << result.maxNs << std::endl;
+    if (!result.countersPerOp.empty()) {
+        std::cout << "    per op:" << std::setprecision(2);
+        for (const auto& counter : result.countersPerOp) {
+            std::cout << " " << counter.first << "=" << counter.second;
+        }
+        std::cout << std::endl;
+    }
+}
+
+inline void writeResultsJson(const std::string& path, const std::string& label, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return;
+    }
+    out << std::fixed << std::setprecision(2);
+    out << "{\n  \"label\": \"" << label << "\",\n  \"cyclesPerNs\": " << cyclesPerNanosecond() << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << "    { \"name\": \"" << r.name << "\", \"operations\": " << r.operations
+            << ", \"seconds\": " << std::setprecision(6) << r.seconds << std::setprecision(2)
+            << ", \"opsPerSecond\": " << r.opsPerSecond << ", \"meanNs\": " << r.meanNs
+            << ", \"p50Ns\": " << r.p50Ns << ", \"p99Ns\": " << r.p99Ns
+            << ", \"p999Ns\": " << r.p999Ns << ", \"maxNs\": " << r.maxNs;
+        if (!r.countersPerOp.empty()) {
+            out << ", \"countersPerOp\": {";
+            for (std::size_t c = 0; c < r.countersPerOp.size(); ++c) {
+                out << (c ? ", " : " ") << "\"" << r.countersPerOp[c].first << "\": " << r.countersPerOp[c].second;
+            }
+            out << " }";
+        }
+        out << " }"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
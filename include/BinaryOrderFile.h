@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+#include "Order.h"
+#include "types.h"
+
+// Fixed-record binary order file: a 32-byte header followed by recordCount
+// 32-byte records. Prices are stored as integer ticks of header.tickSize so
+// loading needs no text or floating-point parsing. Little-endian, like the
+// wire protocol in BinaryProtocol.h.
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "BinaryOrderFile records are mapped as-is and assume a little-endian host");
+
+#pragma pack(push, 1)
+
+struct BinaryOrderFileHeader {
+    char magic[4];            // "OBKF"
+    std::uint32_t version;
+    std::uint64_t recordCount;
+    double tickSize;
+    std::uint64_t reserved;
+};
+
+struct BinaryOrderRecord {
+    std::uint64_t orderId;
+    std::int64_t quantity;
+    std::int64_t priceTicks;
+    std::uint8_t side;        // OrderSide
+    std::uint8_t type;        // OrderType
+    std::uint8_t duration;    // DurationType
+    std::uint8_t reserved[5];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryOrderFileHeader) == 32, "BinaryOrderFileHeader layout changed");
+static_assert(sizeof(BinaryOrderRecord) == 32, "BinaryOrderRecord layout changed");
+
+const std::uint32_t BINARY_ORDER_FILE_VERSION = 1;
+
+// Streams a CSVParse-layout file into the binary format. Prices are rounded
+// to the nearest tick. Returns the number of records written.
+std::uint64_t convertCSVToBinary(const std::string& csvFileName, const std::string& binaryFileName, Price tickSize);
+
+// Zero-copy reader: maps the file and exposes the records in place. Throws
+// std::runtime_error if the header is not a supported order file or the
+// file is truncated.
+class BinaryOrderFile {
+public:
+    explicit BinaryOrderFile(const std::string& fileName);
+
+    const BinaryOrderFileHeader& header() const;
+    std::size_t size() const;
+    Price tickSize() const;
+
+    const BinaryOrderRecord* begin() const;
+    const BinaryOrderRecord* end() const;
+    const BinaryOrderRecord& operator[](std::size_t index) const;
+
+    // For a tick that divides one unit evenly (0.01, 0.25) the price is
+    // priceTicks / ticksPerUnit, the same double the CSV text parses to.
+    // Other ticks multiply.
+    Order toOrder(const BinaryOrderRecord& record) const;
+
+private:
+    MappedFile file_;
+    const BinaryOrderFileHeader* header_;
+    const BinaryOrderRecord* records_;
+    double ticksPerUnit_;  // 0 when the tick does not divide one unit
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#include "Order.h"
+#include "types.h"
+
+// Fixed-length binary order-entry protocol spoken on the server's second
+// listener. Every message is a packed little-endian struct whose first byte
+// is its MessageType, so a reader only needs that byte to know how many more
+// bytes make up the message. Fields map one-to-one onto Order.
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "BinaryProtocol structs are sent as-is and assume a little-endian host");
+
+namespace binary {
+
+enum class MessageType : std::uint8_t {
+    NEW_ORDER = 'N',
+    CANCEL_ORDER = 'C',
+    AMEND_ORDER = 'A',
+    EXECUTION_REPORT = 'E'
+};
+
+enum class ReportType : std::uint8_t {
+    ACCEPTED = 0,   // order rests on the book (possibly after partial fills)
+    FILL = 1,       // one execution against a resting order
+    DONE = 2,       // order fully filled, nothing rests
+    CANCELLED = 3,  // cancel succeeded, or IOC/FOK remainder dropped
+    AMENDED = 4,
+    REJECTED = 5    // unknown, duplicate or another session's order id, malformed request, or risk limit
+};
+
+#pragma pack(push, 1)
+
+struct NewOrderMessage {
+    MessageType msgType;
+    std::uint8_t side;       // OrderSide
+    std::uint8_t type;       // OrderType
+    std::uint8_t duration;   // DurationType
+    std::uint8_t isPersonalOrder;
+    std::uint8_t reserved[3];
+    std::uint64_t clientSeq;
+    std::uint64_t orderId;
+    std::int64_t quantity;
+    double price;
+};
+
+struct CancelOrderMessage {
+    MessageType msgType;
+    std::uint8_t reserved[7];
+    std::uint64_t clientSeq;
+    std::uint64_t orderId;
+};
+
+struct AmendOrderMessage {
+    MessageType msgType;
+    std::uint8_t reserved[7];
+    std::uint64_t clientSeq;
+    std::uint64_t orderId;
+    std::int64_t quantity;
+    double price;
+};
+
+struct ExecutionReport {
+    MessageType msgType;
+    ReportType reportType;
+    std::uint8_t status;     // OrderStatus
+    std::uint8_t side;       // OrderSide
+    std::uint8_t reserved[4];
+    std::uint64_t clientSeq;
+    std::uint64_t orderId;
+    std::uint64_t counterpartyOrderId;
+    std::int64_t lastQuantity;
+    double lastPrice;
+    std::int64_t leavesQuantity;
+    std::int64_t cumQuantity;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(NewOrderMessage) == 40, "NewOrderMessage layout changed");
+static_assert(sizeof(CancelOrderMessage) == 24, "CancelOrderMessage layout changed");
+static_assert(sizeof(AmendOrderMessage) == 40, "AmendOrderMessage layout changed");
+static_assert(sizeof(ExecutionReport) == 64, "ExecutionReport layout changed");
+
+// Size of the message that starts with the given type byte, or 0 if the type
+// is not one a client may send.
+inline std::size_t inboundMessageSize(std::uint8_t type) {
+    switch (static_cast<MessageType>(type)) {
+        case MessageType::NEW_ORDER: return sizeof(NewOrderMessage);
+        case MessageType::CANCEL_ORDER: return sizeof(CancelOrderMessage);
+        case MessageType::AMEND_ORDER: return sizeof(AmendOrderMessage);
+        default: return 0;
+    }
+}
+
+// Decodes from / encodes to raw bytes. memcpy keeps this free of alignment
+// and aliasing issues and compiles down to plain loads and stores.
+template <typename Message>
+inline Message decode(const char* bytes) {
+    Message msg;
+    std::memcpy(&msg, bytes, sizeof(Message));
+    return msg;
+}
+
+template <typename Message>
+inline void encode(const Message& msg, char* bytes) {
+    std::memcpy(bytes, &msg, sizeof(Message));
+}
+
+template <typename Enum>
+inline bool isOneOf(std::uint8_t value, std::initializer_list<Enum> allowed) {
+    for (Enum e : allowed) {
+        if (value == static_cast<std::uint8_t>(e)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// False for a non-positive quantity or an enum byte outside its type's
+// values. Only a valid message may be passed to toOrder().
+inline bool isValid(const NewOrderMessage& msg) {
+    return msg.quantity > 0 && isOneOf(msg.side, {OrderSide::BUY, OrderSide::SELL}) &&
+           isOneOf(msg.type, {OrderType::LIMIT, OrderType::MARKET}) &&
+           isOneOf(msg.duration, {DurationType::GOOD_TILL_CANCELLED, DurationType::IMMEDIATE_OR_CANCEL,
+                                  DurationType::FILL_OR_KILL});
+}
+
+inline Order toOrder(const NewOrderMessage& msg) {
+    return Order(msg.orderId, msg.quantity, msg.price,
+                 static_cast<OrderType>(msg.type),
+                 static_cast<OrderSide>(msg.side),
+                 static_cast<DurationType>(msg.duration),
+                 msg.isPersonalOrder != 0);
+}
+
+inline ExecutionReport makeReport(ReportType reportType, std::uint64_t clientSeq, const Order& order) {
+    ExecutionReport report{};
+    report.msgType = MessageType::EXECUTION_REPORT;
+    report.reportType = reportType;
+    report.status = static_cast<std::uint8_t>(order.getStatus());
+    report.side = static_cast<std::uint8_t>(order.getSide());
+    report.clientSeq = clientSeq;
+    report.orderId = order.getOrderId();
+    report.lastPrice = order.getPrice();
+    report.cumQuantity = order.getFilledQuantity();
+    return report;
+}
+
+} // namespace binary
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Reads the timestamp counter where available, otherwise steady_clock in ns.
+inline std::uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Calibrated once against steady_clock; the TSC is invariant on every x86
+// we run on, so one ratio holds for the whole process.
+inline double cyclesPerNanosecond() {
+    static const double ratio = [] {
+        auto wallStart = std::chrono::steady_clock::now();
+        std::uint64_t cycleStart = readCycles();
+        while (std::chrono::steady_clock::now() - wallStart < std::chrono::milliseconds(50)) {
+        }
+        std::uint64_t cycles = readCycles() - cycleStart;
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wallStart).count();
+        return cycles / ns;
+    }();
+    return ratio;
+}
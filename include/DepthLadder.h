@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "TickBitmap.h"
+#include "types.h"
+
+// What taking `requested` quantity from one side of the book would do.
+struct FillEstimate {
+    Quantity requested = 0;
+    Quantity fillable = 0;       // less than requested if the side runs out
+    double cost = 0.0;           // sum of price * quantity over the fills
+    Price averagePrice = 0.0;    // VWAP of the fillable quantity
+    Price worstPrice = 0.0;      // price at which the cumulative quantity is reached
+};
+
+// Resting quantity of one side of the book, indexed by tick in two Fenwick
+// trees (quantity, and quantity * tick for cost), so cumulative-depth and
+// fill-cost queries take O(log ticks) and each level update does too.
+// Slot 0 is the most aggressive end of the covered range: the lowest tick
+// for asks, the highest for bids. Prices are rounded to the nearest tick.
+// The range starts at INITIAL_TICKS around the first price seen and doubles
+// (an O(ticks) rebuild) whenever a price falls outside it, up to MAX_TICKS.
+// Quantity at a tick the capped range cannot reach is set aside, left out of
+// every answer, and folded in if later growth covers it; complete() is false
+// while there is any. A TickBitmap of the occupied slots gives the best
+// price in a few instructions, however many empty ticks lie in front of it.
+class DepthLadder {
+public:
+    static const std::size_t INITIAL_TICKS = 4096;
+    // About 24 MB of slots and trees per side.
+    static const std::size_t MAX_TICKS = std::size_t(1) << 20;
+
+    // `descending` is true for bids, whose best price is the highest.
+    DepthLadder(Price tickSize, bool descending);
+
+    // Applies a change in resting quantity at `price`.
+    void add(Price price, Quantity delta);
+
+    // False while some quantity rests beyond the covered range, in which case
+    // the queries below only describe the covered part.
+    bool complete() const;
+    Quantity totalQuantity() const;
+    // Best price with quantity (the tick's price), or 0 if the side is empty.
+    Price bestPrice() const;
+    // Quantity resting at prices at least as good as `limit`.
+    Quantity quantityThrough(Price limit) const;
+    FillEstimate estimateFill(Quantity requested) const;
+
+    Price tickSize() const;
+
+private:
+    std::int64_t tickOf(Price price) const;
+    std::int64_t slotOf(std::int64_t tick) const;
+    std::int64_t tickAt(std::size_t slot) const;
+    bool cover(std::int64_t tick);
+    void rebuild();
+    Quantity prefixQuantity(std::size_t slots) const;
+
+    Price tickSize_;
+    bool descending_;
+    bool initialized_ = false;
+    std::int64_t baseTick_ = 0;            // tick held by slot 0
+    std::vector<Quantity> quantityAt_;     // per slot, to rebuild on growth
+    std::vector<Quantity> quantityTree_;   // Fenwick, 1-based
+    std::vector<std::int64_t> notionalTree_;  // Fenwick of quantity * tick, 1-based
+    TickBitmap occupied_;                  // slots with non-zero quantity
+    Quantity total_ = 0;                   // within the covered range
+    std::map<std::int64_t, Quantity> outside_;  // by tick, beyond it
+};
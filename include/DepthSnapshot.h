@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Orderbook.h"
+#include "TopOfBook.h"
+
+using DepthSide = std::vector<BookLevel>;
+
+// An immutable picture of every live level in the book, best first. A side
+// the book has not touched since the previous snapshot is shared with it
+// rather than copied.
+struct DepthSnapshot {
+    std::uint64_t sequence = 0;  // publications so far
+    std::shared_ptr<const DepthSide> bids;
+    std::shared_ptr<const DepthSide> asks;
+    std::uint64_t bidRevision = 0;  // Orderbook::revision() each side was built at
+    std::uint64_t askRevision = 0;
+};
+
+// Publishes DepthSnapshots of one book, read-copy-update style. The book's
+// owner calls publish() at whatever cadence it likes; it builds the next
+// snapshot off to the side and swaps it in with one atomic pointer store.
+// Readers on any thread call acquire() and may keep the result as long as
+// they want: a snapshot is freed by whichever holder drops it last, so the
+// writer never waits for readers and readers never see a half-built view.
+//
+// Only the small box holding the current shared_ptr needs deferred
+// reclamation. acquire() counts itself in `readers_` for the few
+// instructions it takes to copy out of the box; the writer frees retired
+// boxes on a later publish() once it sees that count at zero.
+class DepthSnapshotPublisher {
+public:
+    using Snapshot = std::shared_ptr<const DepthSnapshot>;
+
+    DepthSnapshotPublisher() = default;
+    DepthSnapshotPublisher(const DepthSnapshotPublisher&) = delete;
+    DepthSnapshotPublisher& operator=(const DepthSnapshotPublisher&) = delete;
+
+    ~DepthSnapshotPublisher() {
+        delete current_.load(std::memory_order_relaxed);
+        for (const Snapshot* box : retired_) {
+            delete box;
+        }
+    }
+
+    // Writer only, with the book quiescent. Rebuilds the sides that changed
+    // since the last publish and swaps the result in. False, publishing
+    // nothing, if neither side changed.
+    bool publish(const Orderbook& book) {
+        return publishSides(book.revision(OrderSide::BUY), book.revision(OrderSide::SELL), book.getBids(),
+                            book.getAsks());
+    }
+
+    // Writer only. The same from changes drained from the book's depth
+    // journal, with the revisions read at the drain, so only the drain needs
+    // the book quiescent. The publisher keeps its own copy of the levels to
+    // apply them to; use one form of publish() per publisher.
+    bool publish(const DepthChanges& changes, std::uint64_t bidRevision, std::uint64_t askRevision) {
+        for (const DepthChange& change : changes) {
+            if (change.side == OrderSide::BUY) {
+                applyChange(bidLevels_, change);
+            } else {
+                applyChange(askLevels_, change);
+            }
+        }
+        return publishSides(bidRevision, askRevision, bidLevels_, askLevels_);
+    }
+
+    // Any thread. The latest snapshot, or null before the first publish.
+    Snapshot acquire() const {
+        readers_.fetch_add(1);
+        const Snapshot* box = current_.load();
+        Snapshot snapshot = box ? *box : Snapshot();
+        readers_.fetch_sub(1);
+        return snapshot;
+    }
+
+    // Boxes swapped out but not yet freed; stays small unless acquire() is
+    // being called continuously from several threads at once.
+    std::size_t retiredCount() const {
+        return retired_.size();
+    }
+
+private:
+    template <typename BidLevels, typename AskLevels>
+    bool publishSides(std::uint64_t bidRevision, std::uint64_t askRevision, const BidLevels& bids,
+                      const AskLevels& asks) {
+        const Snapshot* previousBox = current_.load(std::memory_order_relaxed);
+        const DepthSnapshot* previous = previousBox ? previousBox->get() : nullptr;
+        bool bidsCurrent = previous && previous->bidRevision == bidRevision;
+        bool asksCurrent = previous && previous->askRevision == askRevision;
+        if (bidsCurrent && asksCurrent) {
+            return false;
+        }
+
+        auto next = std::make_shared<DepthSnapshot>();
+        next->sequence = previous ? previous->sequence + 1 : 1;
+        next->bidRevision = bidRevision;
+        next->askRevision = askRevision;
+        next->bids = bidsCurrent ? previous->bids : buildSide(bids, previous ? previous->bids->size() : 0);
+        next->asks = asksCurrent ? previous->asks : buildSide(asks, previous ? previous->asks->size() : 0);
+
+        const Snapshot* old = current_.exchange(new Snapshot(std::move(next)));
+        if (old) {
+            retired_.push_back(old);
+        }
+        reclaim();
+        return true;
+    }
+
+    static Quantity levelQuantity(Quantity quantity) { return quantity; }
+    template <typename Record>
+    static Quantity levelQuantity(const BasicPriceLevel<Record>& level) { return level.totalQuantity(); }
+
+    template <typename Levels>
+    static std::shared_ptr<const DepthSide> buildSide(const Levels& levels, std::size_t sizeHint) {
+        auto side = std::make_shared<DepthSide>();
+        side->reserve(sizeHint);
+        for (const auto& level : levels) {
+            Quantity quantity = levelQuantity(level.second);
+            if (quantity > 0) {
+                side->push_back(BookLevel{level.first, quantity});
+            }
+        }
+        return side;
+    }
+
+    template <typename Levels>
+    static void applyChange(Levels& levels, const DepthChange& change) {
+        Quantity& quantity = levels[change.price];
+        quantity += change.delta;
+        if (quantity == 0) {
+            levels.erase(change.price);
+        }
+    }
+
+    // Sequentially consistent with acquire(): if no reader is counted after
+    // the exchange in publish(), any later reader loads the new box, so no
+    // one can still reach a retired one.
+    void reclaim() {
+        if (retired_.empty() || readers_.load() != 0) {
+            return;
+        }
+        for (const Snapshot* box : retired_) {
+            delete box;
+        }
+        retired_.clear();
+    }
+
+    std::atomic<const Snapshot*> current_{nullptr};
+    mutable std::atomic<std::size_t> readers_{0};
+    std::vector<const Snapshot*> retired_;  // writer only
+    // The journal-fed form's copy of the book's live levels; writer only.
+    std::map<Price, Quantity, std::greater<>> bidLevels_;
+    std::map<Price, Quantity> askLevels_;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "CycleClock.h"
+
+// Hot-path latency probes. Build with -DORDERBOOK_PROBES to enable them;
+// otherwise every probe macro expands to nothing and costs nothing.
+//
+// Each thread records into its own histograms, so recording is a couple of
+// timestamp reads plus one uncontended relaxed store: no locks, no shared
+// cache lines. Readers (GET /metrics) sum across threads.
+
+enum class ProbePoint : std::uint8_t {
+    PARSE,
+    BOOK_INSERT,
+    MATCH,
+    CANCEL,
+    SERIALIZE,
+    SEND,
+    COUNT
+};
+
+const char* probePointName(ProbePoint point);
+
+// Log-linear histogram over cycle counts: 16 linear sub-buckets per power of
+// two, so any recorded value is within 1/16 (~6%) of its bucket's lower bound.
+// Single writer; any thread may read concurrently.
+class LogLinearHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKETS = 61 * SUB_BUCKETS;
+
+    static std::size_t bucketFor(std::uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        int shift = 63 - __builtin_clzll(value) - 4;
+        return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1)));
+    }
+
+    static std::uint64_t bucketLowerBound(std::size_t bucket) {
+        std::size_t major = bucket / SUB_BUCKETS;
+        std::uint64_t sub = bucket % SUB_BUCKETS;
+        return major == 0 ? sub : (SUB_BUCKETS + sub) << (major - 1);
+    }
+
+    void record(std::uint64_t value) {
+        std::atomic<std::uint64_t>& slot = counts_[bucketFor(value)];
+        slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t count(std::size_t bucket) const {
+        return counts_[bucket].load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t max() const {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> counts_[BUCKETS] = {};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+// Records one sample for `point` on the calling thread's histogram.
+void recordProbe(ProbePoint point, std::uint64_t cycles);
+
+// Prometheus-style text summary (count, p50/p99/p99.9/max in ns) of every
+// probe, summed over all threads that have recorded.
+std::string renderProbeMetrics();
+
+class ProbeScope {
+public:
+    explicit ProbeScope(ProbePoint point) : point_(point), start_(readCycles()) {}
+    ~ProbeScope() { recordProbe(point_, readCycles() - start_); }
+
+    ProbeScope(const ProbeScope&) = delete;
+    ProbeScope& operator=(const ProbeScope&) = delete;
+
+private:
+    ProbePoint point_;
+    std::uint64_t start_;
+};
+
+#define PROBE_CONCAT_INNER(a, b) a##b
+#define PROBE_CONCAT(a, b) PROBE_CONCAT_INNER(a, b)
+
+#ifdef ORDERBOOK_PROBES
+// Times the rest of the enclosing scope.
+#define LATENCY_PROBE(point) ProbeScope PROBE_CONCAT(latencyProbe_, __LINE__)(point)
+// Times an arbitrary span within one scope.
+#define PROBE_BEGIN(name) std::uint64_t name = readCycles()
+#define PROBE_END(name, point) recordProbe(point, readCycles() - name)
+#else
+#define LATENCY_PROBE(point) do { } while (0)
+#define PROBE_BEGIN(name) do { } while (0)
+#define PROBE_END(name, point) do { } while (0)
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Order.h"
+
+// Memory-mapped reader for the CSVParse layout
+//   orderId,quantity,price,OrderType::X,OrderSide::Y,DurationType::Z
+// Lines are parsed in place with from_chars, so nothing is copied out of the
+// mapping except the resulting Orders. Malformed lines throw
+// std::invalid_argument, matching CSVParse.
+class MappedCSVParse {
+public:
+    // Forward-only cursor over the file's orders; each step parses one line.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Order;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Order*;
+        using reference = const Order&;
+
+        iterator() = default;
+        iterator(const char* pos, const char* end);
+
+        reference operator*() const { return current_; }
+        pointer operator->() const { return &current_; }
+        iterator& operator++();
+        bool operator==(const iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const iterator& other) const { return pos_ != other.pos_; }
+
+    private:
+        void advance();
+
+        const char* pos_ = nullptr;   // start of the current line, nullptr at end
+        const char* next_ = nullptr;  // start of the following line
+        const char* end_ = nullptr;
+        Order current_;
+    };
+
+    using ChunkHandler = std::function<void(std::vector<Order>&)>;
+
+    explicit MappedCSVParse(const std::string& fileName);
+
+    iterator begin() const;
+    iterator end() const;
+
+    std::vector<Order> parseOrders() const;
+
+    // Splits the file into chunks of roughly chunkBytes at newline boundaries
+    // and parses up to numThreads chunks concurrently. onChunk is called on
+    // the calling thread with each chunk's orders strictly in file order, so
+    // it can feed a book directly. At most numThreads chunks are held in
+    // memory at a time.
+    void parseOrdersParallel(unsigned numThreads, const ChunkHandler& onChunk,
+                             size_t chunkBytes = 8 * 1024 * 1024) const;
+
+    // Parses a single CSV line (without its newline). Returns false if the
+    // line has fewer than six fields or a malformed number.
+    static bool parseLine(std::string_view line, Order& order);
+
+private:
+    MappedFile file_;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object, so views handed out by data()/view() must not outlive it.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const;
+    size_t size() const;
+    std::string_view view() const;
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+// Memory resources for giving each Orderbook its own heap. Both are
+// single-threaded (no allocator locks), which matches the book itself: one
+// book is only ever touched by one thread at a time.
+//
+//   BookArena - monotonic: allocation is a pointer bump and nothing is
+//               returned until the arena dies. For books with a bounded
+//               lifetime, e.g. one backtest or one trading session.
+//   BookPool  - per-size-class free lists carved out of an arena, so the
+//               nodes of cancelled and filled orders are reused instead of
+//               growing the arena. For long-lived books with heavy churn.
+//
+// A resource must outlive every book that uses it.
+
+// Bytes a book has allocated and not yet freed, and their peak.
+class ResourceUsage {
+public:
+    std::size_t bytesInUse() const { return bytesInUse_; }
+    std::size_t highWaterBytes() const { return highWaterBytes_; }
+
+protected:
+    void noteAllocate(std::size_t bytes) {
+        bytesInUse_ += bytes;
+        highWaterBytes_ = std::max(highWaterBytes_, bytesInUse_);
+    }
+
+    void noteDeallocate(std::size_t bytes) {
+        bytesInUse_ -= bytes;
+    }
+
+private:
+    std::size_t bytesInUse_ = 0;
+    std::size_t highWaterBytes_ = 0;
+};
+
+class BookArena : public std::pmr::memory_resource, public ResourceUsage {
+public:
+    // initialBytes sizes the first block; later blocks grow geometrically.
+    explicit BookArena(std::size_t initialBytes = 1 << 20)
+        : arena_(initialBytes, std::pmr::new_delete_resource()) {}
+
+    BookArena(const BookArena&) = delete;
+    BookArena& operator=(const BookArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return this; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        noteAllocate(bytes);
+        return arena_.allocate(bytes, alignment);
+    }
+
+    // Freed bytes are not reusable in an arena; only the accounting changes.
+    void do_deallocate(void*, std::size_t bytes, std::size_t) override {
+        noteDeallocate(bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource arena_;
+};
+
+class BookPool : public std::pmr::memory_resource, public ResourceUsage {
+public:
+    explicit BookPool(std::size_t initialBytes = 1 << 20)
+        : arena_(initialBytes, std::pmr::new_delete_resource()) {}
+
+    BookPool(const BookPool&) = delete;
+    BookPool& operator=(const BookPool&) = delete;
+
+    std::pmr::memory_resource* resource() { return this; }
+
+private:
+    // Book nodes (map, list and hash nodes) are all well under MAX_POOLED.
+    // Larger blocks are the hash index's bucket arrays, which are replaced
+    // on every rehash, so they go to the global heap to actually be freed.
+    static constexpr std::size_t GRANULE = 16;
+    static constexpr std::size_t MAX_POOLED = 256;
+    static constexpr std::size_t SIZE_CLASSES = MAX_POOLED / GRANULE;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static bool pooled(std::size_t bytes, std::size_t alignment) {
+        return bytes <= MAX_POOLED && alignment <= GRANULE;
+    }
+
+    static std::size_t sizeClass(std::size_t bytes) {
+        return bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        noteAllocate(bytes);
+        if (!pooled(bytes, alignment)) {
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        FreeBlock*& head = freeLists_[sizeClass(bytes)];
+        if (head != nullptr) {
+            FreeBlock* block = head;
+            head = block->next;
+            return block;
+        }
+        return arena_.allocate((sizeClass(bytes) + 1) * GRANULE, GRANULE);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        noteDeallocate(bytes);
+        if (!pooled(bytes, alignment)) {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            return;
+        }
+        FreeBlock*& head = freeLists_[sizeClass(bytes)];
+        head = new (p) FreeBlock{head};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource arena_;
+    FreeBlock* freeLists_[SIZE_CLASSES] = {};
+};
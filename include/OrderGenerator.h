@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Order.h"
+#include "Orderbook.h"
+#include "Random.h"
+#include "types.h"
+
+class OrderGenerator {
+public:
+    static constexpr std::uint64_t DEFAULT_SEED = 0x6f72646572626f6fULL;
+
+    // Generators built with the same seed and stream produce identical
+    // orders; give each thread its own stream to generate in parallel.
+    explicit OrderGenerator(Orderbook& orderbook, std::uint64_t seed = DEFAULT_SEED, std::uint64_t stream = 0);
+
+    void setType(OrderType type);
+    void reseed(std::uint64_t seed, std::uint64_t stream = 0);
+
+    std::vector<Order> generateOrders(int num_orders, OrderID& nextOrderID);
+    std::vector<Order> generateOrdersFixedRange(int num_orders, OrderID& nextOrderID);
+
+    // Fills a preallocated buffer instead of returning a new vector, so hot
+    // loops can reuse one allocation across calls.
+    void generateInto(Order* orders, std::size_t count, OrderID& nextOrderID);
+    void generateIntoFixedRange(Order* orders, std::size_t count, OrderID& nextOrderID);
+
+    Xoshiro256& rng();
+
+private:
+    Price getRandomPriceAroundMid(Price midPrice);
+    Order makeOrder(OrderID id, Price price);
+
+    Orderbook& orderbook_;
+    Xoshiro256 rng_;
+    OrderType type_ = OrderType::LIMIT;
+    Price defaultPrice_ = 100.0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string_view>
+
+#include "Order.h"
+#include "types.h"
+
+// Parses one flat JSON order object such as
+//   { "orderId": 1, "price": 100.5, "quantity": 10, "side": "BUY",
+//     "type": "LIMIT", "duration": "IMMEDIATE_OR_CANCEL", "isPersonalOrder": true }
+// without allocating. orderId, quantity and price are required; side, type
+// and duration default to BUY, LIMIT and GOOD_TILL_CANCELLED. Returns false
+// and leaves order untouched if the object is malformed.
+bool parseOrderJson(std::string_view json, Order& order);
+
+const char* orderStatusName(OrderStatus status);
@@ -0,0 +1,493 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DepthLadder.h"
+#include "Order.h"
+#include "TickPrice.h"
+#include "TopOfBook.h"
+#include "types.h"
+
+struct TradeChild {
+    TradeChild();
+    TradeChild(OrderID id, Price p, Quantity q, bool isPersonal);
+
+    OrderID orderID;
+    Price price;
+    Quantity quantity;
+    bool isPersonalOrder;
+};
+
+class Trade {
+public:
+    Trade(const TradeChild& buyOrder, const TradeChild& sellOrder, Price executionPrice);
+
+    const TradeChild& getBuyOrder() const;
+    const TradeChild& getSellOrder() const;
+    Price getPrice() const;
+    const Quantity getTradedQuantity() const;
+
+private:
+    TradeChild buyOrder_;
+    TradeChild sellOrder_;
+    Price executionPrice_;
+};
+
+using TradeList = std::vector<Trade>;
+
+// Participant (account, session) an order belongs to, for mass cancels.
+// Orders added without one are not tracked by owner.
+using OwnerID = std::uint32_t;
+constexpr OwnerID NO_OWNER = 0;
+
+// Outcome of a call auction uncross. `imbalance` is demand minus supply at
+// the uncrossing price: the surplus that stays in the book afterwards.
+struct AuctionResult {
+    Price price = 0.0;      // 0 if the book does not cross
+    Quantity volume = 0;
+    Quantity imbalance = 0;
+    TradeList trades;       // empty for an indicative uncross
+};
+
+// Frequent batch auction triggers. A batch clears once it holds maxOrders
+// orders or when the clock passes the end of its `interval`-long window;
+// zero disables a trigger, and both zero turns batching off.
+struct BatchConfig {
+    std::size_t maxOrders = 0;
+    Timestamp interval = 0;  // ns, on the clock passed to advanceClock()
+};
+
+// One change to the resting quantity at a price, as the depth journal
+// records it.
+struct DepthChange {
+    OrderSide side;
+    Price price;
+    Quantity delta;
+};
+
+using DepthChanges = std::pmr::vector<DepthChange>;
+
+// Heap footprint of one of the book's containers. `bytesUsed` is the payload
+// the book actually needs (the stored values); `bytesReserved` is what the
+// allocator holds for it, including node links, malloc rounding and hash
+// buckets. Both are derived from element counts, so they cost O(1) to read.
+// bytesReserved models the global malloc heap; a book on a BookArena or
+// BookPool reports its exact usage through that resource instead.
+struct MemoryUsage {
+    std::size_t elements = 0;
+    std::size_t bytesUsed = 0;
+    std::size_t bytesReserved = 0;
+    std::size_t highWaterBytes = 0;  // peak bytesReserved since construction
+};
+
+struct BookMemoryStats {
+    MemoryUsage bidLevels;     // `bids` map nodes
+    MemoryUsage askLevels;     // `asks` map nodes
+    MemoryUsage levelQueues;   // list nodes, one per hot RestingOrder record
+    MemoryUsage orderIndex;    // `orders` hash nodes (cold Order data) plus bucket array
+
+    std::size_t restingOrders = 0;
+    std::size_t tombstones = 0;  // lazily cancelled orders not yet reclaimed
+    std::size_t totalBytesUsed = 0;
+    std::size_t totalBytesReserved = 0;
+    std::size_t highWaterBytes = 0;  // sum of the per-structure peaks
+    double bytesPerOrder = 0.0;  // totalBytesReserved / restingOrders
+};
+
+// The hot part of a resting order: the only fields the match loop reads or
+// writes. Level queues hold these; everything else about the order (price,
+// fills, type, duration, timestamps) lives in the book's ID index and is
+// only touched on a partial fill, cancel or lookup. The field widths come
+// from the book's BookTraits.
+template <typename QuantityRep, typename OrderIdRep>
+struct BasicRestingOrder {
+    OrderIdRep orderId;
+    QuantityRep quantity;  // remaining
+    bool isPersonalOrder;
+
+    OrderID getOrderId() const { return orderId; }
+    Quantity getQuantity() const { return quantity; }
+    bool getIsPersonalOrder() const { return isPersonalOrder; }
+    // A lazily cancelled order left in its queue until it is reclaimed.
+    bool isDead() const { return quantity == 0; }
+};
+
+using RestingOrder = BasicRestingOrder<Quantity, OrderID>;
+
+// Each record sits in its own list node next to two links, so this bounds
+// the node at 40 bytes; records are not stored contiguously.
+static_assert(sizeof(RestingOrder) <= 24, "RestingOrder should keep a queue node within 40 bytes");
+
+// Every container in the book allocates from one std::pmr::memory_resource,
+// the global heap by default. See MemoryResources.h for per-book arenas.
+template <typename Record>
+using BasicOrderQueue = std::pmr::list<Record>;
+using OrderQueue = BasicOrderQueue<RestingOrder>;
+
+// The FIFO queue at one price plus its aggregate remaining quantity, so the
+// match loop can tell before touching any order whether an incoming order
+// consumes the whole level. All quantity changes go through the members
+// below to keep the aggregate exact. The aggregate is always a full-width
+// Quantity, however narrow the records are.
+template <typename Record>
+class BasicPriceLevel {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<Record>;
+    using iterator = typename BasicOrderQueue<Record>::iterator;
+    using const_iterator = typename BasicOrderQueue<Record>::const_iterator;
+
+    // Copies and moves start any compaction pass over.
+    explicit BasicPriceLevel(const allocator_type& alloc = {}) : orders_(alloc), resume_(orders_.end()) {}
+    BasicPriceLevel(const BasicPriceLevel& other, const allocator_type& alloc = {})
+        : orders_(other.orders_, alloc), totalQuantity_(other.totalQuantity_), deadCount_(other.deadCount_),
+          resume_(orders_.end()) {}
+    BasicPriceLevel(BasicPriceLevel&& other)
+        : orders_(std::move(other.orders_)), totalQuantity_(other.totalQuantity_), deadCount_(other.deadCount_),
+          resume_(orders_.end()) {}
+    BasicPriceLevel(BasicPriceLevel&& other, const allocator_type& alloc)
+        : orders_(std::move(other.orders_), alloc), totalQuantity_(other.totalQuantity_),
+          deadCount_(other.deadCount_), resume_(orders_.end()) {}
+    BasicPriceLevel& operator=(const BasicPriceLevel&) = delete;
+    BasicPriceLevel& operator=(BasicPriceLevel&&) = delete;
+
+    Quantity totalQuantity() const { return totalQuantity_; }
+    std::size_t size() const { return orders_.size(); }  // includes dead orders
+    std::size_t deadCount() const { return deadCount_; }
+    bool empty() const { return orders_.empty(); }
+
+    iterator begin() { return orders_.begin(); }
+    iterator end() { return orders_.end(); }
+    const_iterator begin() const { return orders_.begin(); }
+    const_iterator end() const { return orders_.end(); }
+    const Record& front() const { return orders_.front(); }
+
+    iterator append(const Record& order) {
+        totalQuantity_ += order.quantity;
+        return orders_.insert(orders_.end(), order);
+    }
+
+    iterator erase(iterator it) {
+        if (it->isDead()) {
+            --deadCount_;
+        } else {
+            totalQuantity_ -= it->quantity;
+        }
+        bool atResume = it == resume_;
+        it = orders_.erase(it);
+        if (atResume) {
+            resume_ = it;
+        }
+        return it;
+    }
+
+    // Marks a live order dead in place. True if it is the level's first dead
+    // order, i.e. the level now needs compacting.
+    bool kill(iterator it) {
+        totalQuantity_ -= it->quantity;
+        it->quantity = 0;
+        return ++deadCount_ == 1;
+    }
+
+    // Adjusts one order's remaining quantity by delta (negative on fills).
+    void adjust(iterator it, Quantity delta) {
+        it->quantity += delta;
+        totalQuantity_ += delta;
+    }
+
+    // Where an interrupted compaction pass picks up; end() if none is under
+    // way. erase() keeps it valid.
+    iterator resumePoint() const { return resume_; }
+    void setResumePoint(iterator it) { resume_ = it; }
+
+private:
+    BasicOrderQueue<Record> orders_;
+    Quantity totalQuantity_ = 0;
+    std::size_t deadCount_ = 0;
+    iterator resume_;
+};
+
+using PriceLevel = BasicPriceLevel<RestingOrder>;
+
+template <typename Key, typename Level>
+using BasicBidLevels = std::pmr::map<Key, Level, std::greater<>>;
+template <typename Key, typename Level>
+using BasicAskLevels = std::pmr::map<Key, Level, std::less<>>;
+
+using BidLevels = BasicBidLevels<Price, PriceLevel>;
+using AskLevels = BasicAskLevels<Price, PriceLevel>;
+
+// Compile-time shape of a book. PriceKey is how level prices are stored
+// (Price, or a TickPrice for an instrument with a fixed tick); QuantityRep
+// and OrderIdRep size the per-order records in the level queues. MaxLevels
+// caps the levels on each side and MaxOrders the orders in the book (dead
+// ones included), 0 meaning unbounded; the remainder of an order that would
+// exceed either is cancelled instead of resting. An order whose ID,
+// quantity or limit price does not fit these types is cancelled on arrival.
+// The defaults are the global types with no bounds, under which every
+// check here folds away.
+template <typename PriceKeyT = Price, typename QuantityRepT = Quantity, typename OrderIdRepT = OrderID,
+          std::size_t MaxLevels = 0, std::size_t MaxOrders = 0>
+struct BookTraits {
+    using PriceKey = PriceKeyT;
+    using QuantityRep = QuantityRepT;
+    using OrderIdRep = OrderIdRepT;
+    static constexpr std::size_t MAX_LEVELS = MaxLevels;
+    static constexpr std::size_t MAX_ORDERS = MaxOrders;
+
+    static bool accepts(const Order& order) {
+        if (order.getQuantity() > std::numeric_limits<QuantityRep>::max() ||
+            order.getOrderId() > std::numeric_limits<OrderIdRep>::max()) {
+            return false;
+        }
+        if constexpr (std::is_same<PriceKey, Price>::value) {
+            return true;
+        } else {
+            return order.getType() == OrderType::MARKET || PriceKey::representable(order.getPrice());
+        }
+    }
+};
+
+// Every BasicOrderbook configuration used is explicitly instantiated at the
+// end of Orderbook.cpp; add one there to use another.
+template <typename Traits>
+class BasicOrderbook {
+public:
+    using PriceKey = typename Traits::PriceKey;
+    using Record = BasicRestingOrder<typename Traits::QuantityRep, typename Traits::OrderIdRep>;
+    using Level = BasicPriceLevel<Record>;
+    using Bids = BasicBidLevels<PriceKey, Level>;
+    using Asks = BasicAskLevels<PriceKey, Level>;
+
+    // `resource` must outlive the book. Books are only moved or assigned
+    // between books on the same resource.
+    explicit BasicOrderbook(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Full view of a resting order, or nullptr. Valid until the order
+    // leaves the book.
+    const Order* getOrder(OrderID id) const;
+    // True if an order with this ID rests in the book or waits in the open
+    // batch. addOrder() sets such an order CANCELLED and changes nothing.
+    bool hasLiveOrder(OrderID id) const;
+    TradeList addOrder(Order& order, OwnerID owner = NO_OWNER);
+    bool cancelOrder(OrderID& orderID);
+    // Reduces a resting order to newQuantity in place, keeping its queue
+    // position. False if it is not resting or newQuantity is not a reduction.
+    bool reduceOrder(OrderID id, Quantity newQuantity);
+    // Amends a resting order to `quantity` at `price`. A reduction at an
+    // unchanged price is made in place; anything else cancels the order and
+    // adds a replacement with the same ID, type, side, duration and owner,
+    // which goes to the back of its level and may trade. Returns the
+    // replacement's trades; does nothing if the order is not resting or
+    // `quantity` is not positive.
+    TradeList amendOrder(OrderID id, Quantity quantity, Price price);
+
+    // Lazy cancel: cancelOrder only marks the order dead and takes its
+    // quantity out of the level total; the queue entry, index entry and any
+    // emptied level are reclaimed later, by matching as it passes them or by
+    // compact(). Until then getBids()/getAsks() may show dead orders
+    // (quantity 0) and levels whose total is 0; the best-price and interest
+    // queries skip them. Off by default.
+    void setLazyCancel(bool enabled);
+    bool lazyCancel() const;
+    // Reclaims dead orders, visiting at most `budget` queue entries so it can
+    // be run in small steps between events. Returns how many it reclaimed.
+    std::size_t compact(std::size_t budget = SIZE_MAX);
+    std::size_t tombstoneCount() const;
+
+    // Mass cancels, for kill switches and disconnects. Each takes time
+    // proportional to the orders it removes, found through intrusive
+    // per-owner lists or the level's own queue, and returns how many it
+    // cancelled. Owner cancels go through the normal cancel path (so honour
+    // lazy cancel); a level cancel removes the level outright. Orders still
+    // queued in an open batch are not affected.
+    std::size_t cancelOwner(OwnerID owner);
+    std::size_t cancelOwner(OwnerID owner, OrderSide side);
+    std::size_t cancelLevel(OrderSide side, Price price);
+    // Live resting orders of `owner`; walks its lists.
+    std::size_t ownerOrderCount(OwnerID owner) const;
+    // The owner a resting order was added under; NO_OWNER if it has none or
+    // is not resting.
+    OwnerID getOwner(OrderID id) const;
+
+    const Bids& getBids() const;
+    const Asks& getAsks() const;
+
+    const Price getHighestBid() const;
+    const Price getLowestAsk() const;
+    const Price getMidPrice() const;
+    // The best TopOfBook::DEPTH live levels of each side, for publishing
+    // through a TopOfBookPublisher. Sequence and last trade are left unset.
+    TopOfBook topOfBook() const;
+
+    const Quantity getBidInterest() const;
+    const Quantity getSellInterest() const;
+    const Quantity getNetInterest() const;
+
+    // Cumulative depth queries. Without an index they walk the levels; after
+    // enableDepthIndex() each is O(log ticks), with every add, fill, cancel
+    // and reduce updating the index in O(log ticks). The tick size must
+    // divide every price the book will see. The index spans at most
+    // DepthLadder::MAX_TICKS ticks per side; while orders rest beyond that,
+    // queries on that side walk the levels again.
+    void enableDepthIndex(Price tickSize);
+    bool depthIndexed() const;
+    // Ask quantity a buyer could take at prices up to and including limit.
+    Quantity askDepthThrough(Price limit) const;
+    // Bid quantity a seller could hit at prices down to and including limit.
+    Quantity bidDepthThrough(Price limit) const;
+    // Cost, VWAP and worst price of buying or selling `quantity` against the
+    // book right now, as if by a market order.
+    FillEstimate estimateBuy(Quantity quantity) const;
+    FillEstimate estimateSell(Quantity quantity) const;
+
+    // Call auction, for the open and close. After beginAuction(), limit
+    // orders rest without matching even when they cross; market, IOC and FOK
+    // orders are cancelled as there is nothing to execute against yet.
+    // uncross() picks the price that maximizes executed volume, then the one
+    // with the smallest imbalance, then the side of the market pressure (the
+    // highest price if every candidate has surplus demand, the lowest if
+    // surplus supply), then the price closest to `referencePrice`. It
+    // executes every crossing order at that price, in price-time priority,
+    // and returns the book to continuous matching. Finding the price is
+    // linear in the number of crossing levels.
+    void beginAuction();
+    bool inAuction() const;
+    // The uncross the book would do now, without trading.
+    AuctionResult indicativeUncross(Price referencePrice) const;
+    AuctionResult uncross(Price referencePrice);
+
+    // Frequent batch auctions. While batching, addOrder() queues the order
+    // instead of matching it and returns the trades of any batch it
+    // completes. A batch clears as one uniform-price uncross against the
+    // resting book (same rules as uncross(), referenced to the mid or the
+    // last clearing price); within a price, resting orders keep priority
+    // over the batch and the batch keeps arrival order. Market and FOK
+    // orders are cancelled on arrival, and IOC orders lose whatever the
+    // batch does not fill. Queued orders can be cancelled but are not
+    // visible to getOrder() until their batch clears, and the caller's Order
+    // is not updated with their fills. Changing the mode first clears any
+    // open batch, under the old settings, and returns its trades.
+    TradeList setBatchMode(const BatchConfig& config);
+    bool batching() const;
+    // Moves the batch clock; clears the open batch if its window has ended.
+    TradeList advanceClock(Timestamp now);
+    TradeList clearBatch();
+    std::size_t pendingBatchSize() const;
+    // Called during a clear with the ID of each batch order that leaves
+    // without resting or filling completely: an IOC remainder, or an order
+    // the book had no room for. Its fills are in the trades the clear
+    // returns, which the handler has not seen yet.
+    void setBatchDropHandler(std::function<void(OrderID)> handler);
+
+    // Counts changes to one side's resting quantity, so a consumer can tell
+    // that a side is unchanged since it last looked without walking it.
+    std::uint64_t revision(OrderSide side) const;
+    // Depth journal, for a consumer that mirrors the levels away from the
+    // book. Once enabled it holds an entry per existing level, then one per
+    // change to a level's resting quantity, until drained. Draining swaps
+    // the journal into `out` in O(1) if `out` uses the book's resource.
+    void enableDepthJournal();
+    void drainDepthChanges(DepthChanges& out);
+
+    BookMemoryStats memoryStats() const;
+    std::pmr::memory_resource* resource() const;
+
+private:
+    struct OrderInfo {
+        Order order;  // cold copy; quantity kept in step with the hot record
+        typename Level::iterator orderIterator;
+        typename Asks::iterator priceIterator;  // same node type for either side
+        OrderSide side;
+        // Links in the owner's list for this side; index nodes never move.
+        OwnerID owner = NO_OWNER;
+        OrderInfo* ownerPrev = nullptr;
+        OrderInfo* ownerNext = nullptr;
+    };
+
+    // Heads of one owner's live resting orders, per side.
+    struct OwnerOrders {
+        OrderInfo* head[2] = {nullptr, nullptr};  // BUY, SELL
+    };
+
+    using OrderIndex = std::pmr::unordered_map<OrderID, OrderInfo>;
+
+    bool restOrder(const Order& order, OwnerID owner);
+    bool hasCapacity(OrderSide side, Price price) const;
+    AuctionResult executeUncross(Price referencePrice);
+    void sweepLevel(Order& order, Price price, const Level& level, TradeList& trades);
+    void fillResting(Level& level, OrderSide side, Price price, Quantity quantity);
+    void releaseTombstone(const Record& record);
+    bool cancelResting(typename OrderIndex::iterator it);
+    std::size_t cancelOwnerSide(OwnerID owner, OrderSide side);
+    template <typename Levels>
+    std::size_t cancelLevelIn(Levels& levels, OrderSide side, Price price);
+    void eraseOrder(OrderID id);
+    void linkOwner(OrderInfo& info);
+    void unlinkOwner(OrderInfo& info);
+    template <typename Levels>
+    bool compactLevel(Levels& levels, Price price, std::size_t budget, std::size_t& visited, std::size_t& reclaimed);
+    void rollbackTrades(const TradeList& trades);
+    void noteFootprint();
+    void noteDepth(OrderSide side, Price price, Quantity delta);
+
+    // Peak container sizes, from which memoryStats() derives high-water marks.
+    struct Footprint {
+        std::size_t bidLevels = 0;
+        std::size_t askLevels = 0;
+        std::size_t orders = 0;
+        std::size_t buckets = 0;
+    };
+
+    Bids bids;
+    Asks asks;
+    OrderIndex orders;
+    Footprint peak_;
+    std::pmr::unordered_map<OwnerID, OwnerOrders> owners_;  // owners with live orders
+
+    // Levels holding dead orders, most recent last. Entries can be stale
+    // (level since swept or compacted); compact() skips those.
+    std::pmr::vector<std::pair<OrderSide, Price>> dirtyLevels_;
+    std::size_t tombstones_ = 0;
+    bool lazyCancel_ = false;
+    bool auction_ = false;
+
+    BatchConfig batch_;
+    std::pmr::vector<Order> pending_;  // the open batch, in arrival order
+    std::pmr::vector<OwnerID> pendingOwners_;  // parallel to pending_
+    std::pmr::unordered_map<OrderID, std::size_t> pendingIndex_;  // live entries of pending_
+    Timestamp batchDeadline_ = 0;
+    Price lastClearingPrice_ = 0.0;
+    std::function<void(OrderID)> batchDropHandler_;
+
+    std::uint64_t bidRevision_ = 0;
+    std::uint64_t askRevision_ = 0;
+    bool journalDepth_ = false;
+    DepthChanges depthJournal_;
+
+    // Resting quantity by tick; empty unless enableDepthIndex() was called.
+    std::optional<DepthLadder> bidDepth_;
+    std::optional<DepthLadder> askDepth_;
+};
+
+// The book everything else uses: Price keys, full-width records, unbounded.
+using Orderbook = BasicOrderbook<BookTraits<>>;
+
+// For instruments on a cent grid within about +/-21 million, with order IDs
+// and sizes that fit 32 bits: half-size queue records and integer level
+// keys, at most 65536 levels a side and 2^20 orders.
+using CompactBookTraits = BookTraits<TickPrice<std::int32_t, 100>, std::int32_t, std::uint32_t, 1 << 16, 1 << 20>;
+using CompactOrderbook = BasicOrderbook<CompactBookTraits>;
+
+static_assert(sizeof(CompactOrderbook::Record) <= 12, "compact records should be half the size of RestingOrder");
@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+ * C interface to Orderbook, for ctypes/cffi callers such as the Python
+ * tooling. Books are opaque handles; orders go in and results, depth and
+ * trades come out as arrays of the fixed-layout structs below, so a caller
+ * can view them as NumPy structured arrays without copying. Every struct is
+ * naturally aligned with explicit padding; the NumPy dtype that matches is
+ * given beside each one.
+ *
+ * A handle may be used from one thread at a time; separate handles are
+ * independent. Enum fields hold the numeric values of OrderSide, OrderType,
+ * DurationType and OrderStatus.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ob_book ob_book;
+
+/* owner is the participant for ob_cancel_owner; 0 for none.
+ * [('order_id','u8'),('quantity','i8'),('price','f8'),('side','u1'),
+ *  ('type','u1'),('duration','u1'),('is_personal','u1'),('owner','u4')] */
+typedef struct ob_order {
+    uint64_t order_id;
+    int64_t quantity;
+    double price;
+    uint8_t side;
+    uint8_t type;
+    uint8_t duration;
+    uint8_t is_personal;
+    uint32_t owner;
+} ob_order;
+
+/* status is OB_REJECTED for an order that was not submitted: a
+ * non-positive quantity, a NaN or infinite price, an out-of-range enum
+ * field, or the ID of an order still live on the book.
+ * [('order_id','u8'),('filled_quantity','i8'),('status','u1'),('reserved','u1',7)] */
+#define OB_REJECTED 0xFF
+
+typedef struct ob_order_result {
+    uint64_t order_id;
+    int64_t filled_quantity;
+    uint8_t status;
+    uint8_t reserved[7];
+} ob_order_result;
+
+/* [('price','f8'),('quantity','i8')] */
+typedef struct ob_level {
+    double price;
+    int64_t quantity;
+} ob_level;
+
+/* [('buy_order_id','u8'),('sell_order_id','u8'),('price','f8'),('quantity','i8')] */
+typedef struct ob_trade {
+    uint64_t buy_order_id;
+    uint64_t sell_order_id;
+    double price;
+    int64_t quantity;
+} ob_trade;
+
+/* Every live level of the book, best first on each side. */
+typedef struct ob_depth {
+    const ob_level* bids;
+    size_t bid_count;
+    const ob_level* asks;
+    size_t ask_count;
+} ob_depth;
+
+/* NULL if the book could not be allocated. */
+ob_book* ob_book_create(void);
+void ob_book_destroy(ob_book* book);
+
+/* Submits `count` orders in order. If `results` is not NULL it receives one
+ * entry per order. Returns the number of trades appended to the tape. */
+size_t ob_submit_orders(ob_book* book, const ob_order* orders, size_t count, ob_order_result* results);
+/* 1 if the order was resting and is now cancelled, else 0. */
+int ob_cancel_order(ob_book* book, uint64_t order_id);
+/* Cancels every resting order of `owner`; returns how many. */
+size_t ob_cancel_owner(ob_book* book, uint32_t owner);
+
+/* Points `out` at arrays owned by the book. They stay valid and unchanged,
+ * whatever the book does meanwhile, until the next ob_get_depth call on the
+ * same handle or ob_book_destroy. Sides unchanged since the previous call
+ * are not rebuilt. */
+void ob_get_depth(ob_book* book, ob_depth* out);
+
+/* Every trade since creation or the last ob_clear_trades, oldest first.
+ * The array is valid until the next call that submits or clears. */
+size_t ob_get_trades(const ob_book* book, const ob_trade** trades);
+void ob_clear_trades(ob_book* book);
+
+/* Legacy single-order helper; the string is per calling thread and valid
+ * until that thread's next call. */
+const char* create_order(int orderId, int quantity, double price, const char* type, const char* side);
+
+#ifdef __cplusplus
+}
+#endif
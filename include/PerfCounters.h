@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters around a measured region, via Linux
+// perf_event_open. Each event is opened on its own so one the CPU or the
+// container does not support just drops out; if none open, available() is
+// false and the benchmarks fall back to wall-clock numbers alone. Counts are
+// scaled by time_enabled/time_running when the kernel multiplexes them.
+class PerfCounters {
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        auto cache = [](std::uint64_t cacheId, std::uint64_t op, std::uint64_t result) {
+            return cacheId | (op << 8) | (result << 16);
+        };
+        open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open("l1d_misses", PERF_TYPE_HW_CACHE,
+             cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        open("llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open("dtlb_misses", PERF_TYPE_HW_CACHE,
+             cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (const Counter& counter : counters_) {
+            close(counter.fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        return !counters_.empty();
+    }
+
+    void start() {
+#if defined(__linux__)
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Re-enables without resetting, to accumulate over disjoint regions.
+    void resume() {
+#if defined(__linux__)
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    // Scaled counts since the last start(), divided by `operations`.
+    std::vector<std::pair<std::string, double>> perOperation(std::size_t operations) const {
+        std::vector<std::pair<std::string, double>> values;
+#if defined(__linux__)
+        for (const Counter& counter : counters_) {
+            std::uint64_t data[3] = {0, 0, 0};  // value, time_enabled, time_running
+            if (::read(counter.fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            double scaled = static_cast<double>(data[0]) * data[1] / data[2];
+            values.emplace_back(counter.name, operations > 0 ? scaled / operations : scaled);
+        }
+#endif
+        return values;
+    }
+
+private:
+    struct Counter {
+        std::string name;
+        int fd;
+    };
+
+#if defined(__linux__)
+    void open(const char* name, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0) {
+            counters_.push_back({name, static_cast<int>(fd)});
+        }
+    }
+#endif
+
+    std::vector<Counter> counters_;
+};
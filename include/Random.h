@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** (Blackman & Vigna): small, fast, and statistically strong
+// enough for workload generation. Each instance owns its state, so
+// generators on different threads never share or contend on anything.
+// Satisfies UniformRandomBitGenerator, so it also works with <random>
+// distributions.
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+        reseed(seed, stream);
+    }
+
+    // Expands seed with splitmix64, then jumps 2^128 steps per stream so
+    // instances built from the same seed with distinct streams never overlap.
+    void reseed(std::uint64_t seed, std::uint64_t stream = 0) {
+        for (std::uint64_t& word : s_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+        for (std::uint64_t i = 0; i < stream; ++i) {
+            jump();
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() { return next(); }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const std::uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, bound) using Lemire's multiply-shift; the bias
+    // is below 2^-32 for any bound used here, so no rejection loop.
+    std::uint64_t uniform(std::uint64_t bound) {
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    // Uniform double in [0, 1).
+    double uniformDouble() {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+    void jump() {
+        static const std::uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                             0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        std::uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (std::uint64_t word : JUMP) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (std::uint64_t{1} << b)) {
+                    s0 ^= s_[0];
+                    s1 ^= s_[1];
+                    s2 ^= s_[2];
+                    s3 ^= s_[3];
+                }
+                next();
+            }
+        }
+        s_[0] = s0;
+        s_[1] = s1;
+        s_[2] = s2;
+        s_[3] = s3;
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t s_[4];
+};
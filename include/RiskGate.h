@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "Order.h"
+#include "Orderbook.h"
+#include "types.h"
+
+// Per-account pre-trade limits. Zero disables a limit; the defaults disable
+// them all.
+struct RiskLimits {
+    Quantity maxOrderQuantity = 0;
+    // Price times remaining quantity, summed over the account's open limit
+    // orders including the new one.
+    double maxOpenNotional = 0.0;
+    // Bound on the net position if every open order on the new order's side
+    // filled, the new one included.
+    Quantity maxPosition = 0;
+    // Accepted orders per one-second window.
+    std::uint32_t maxOrdersPerSecond = 0;
+};
+
+enum class RiskReject : std::uint8_t { NONE, ORDER_QUANTITY, OPEN_NOTIONAL, POSITION, ORDER_RATE, DUPLICATE_ORDER_ID, ACCOUNT_MISMATCH };
+
+const char* riskRejectName(RiskReject reject);
+
+// An account's running state, as the gate's checks read it.
+struct RiskExposure {
+    Quantity position = 0;  // net filled quantity, buys positive
+    Quantity openBuyQuantity = 0;
+    Quantity openSellQuantity = 0;
+    double openNotional = 0.0;
+    Timestamp windowStart = 0;
+    std::uint32_t windowOrders = 0;
+};
+
+// Pre-trade risk gate in front of Orderbook::addOrder. Each account's
+// exposure is kept up to date from the fills and cancels it is told about,
+// so a check is one hash lookup and a handful of compares and never looks
+// at the trade history. Accounts are book owners: submit() rests orders
+// under the account's OwnerID, which is what cancelAccount() relies on.
+//
+// The gate only sees what it is shown. Every TradeList the book returns,
+// from any caller, has to go through onTrades(), since another order may
+// fill one of the account's resting orders; submit() does this for its own
+// order. A cancel or amend made on the book directly has to be followed by
+// sync(). Tracking is keyed by order ID, so submit() refuses an ID that is
+// still live on the book, which the book would refuse too. Orders queued in an open batch are tracked at their full
+// quantity until their batch clears. submit() on a batching book installs
+// the book's batch drop handler, so an order the clear drops is released
+// by the onTrades() call that applies the clear's trades.
+class RiskGate {
+public:
+    // Tracked orders and accounts allocate from `resource`, which must
+    // outlive the gate; a book's BookPool can be shared.
+    explicit RiskGate(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Limits for accounts without their own; applies to accounts the gate
+    // has not seen yet.
+    void setDefaultLimits(const RiskLimits& limits);
+    void setLimits(OwnerID account, const RiskLimits& limits);
+    const RiskLimits& limits(OwnerID account) const;
+    // nullptr if the account has never had an order accepted or limits set.
+    const RiskExposure* exposure(OwnerID account) const;
+
+    // Whether `order` would be accepted for `account` at time `now` (ns, on
+    // any monotonic clock the caller keeps using). Changes nothing.
+    RiskReject check(const Order& order, OwnerID account, Timestamp now) const;
+
+    // Checks the order and, if it passes, adds it to the book for `account`
+    // and applies the resulting trades. A rejected order is set CANCELLED
+    // and never reaches the book; `reject` receives the reason either way.
+    // An ID the book still holds is DUPLICATE_ORDER_ID and changes nothing.
+    template <typename Book>
+    TradeList submit(Book& book, Order& order, OwnerID account, Timestamp now, RiskReject* reject = nullptr);
+
+    // Amends a resting order through Book::amendOrder for `account`. A
+    // replacement is checked like a new order, with the exposure of the order
+    // it replaces taken out first; a reduction in place only lowers exposure
+    // and is not checked. An order resting under another account is refused
+    // as ACCOUNT_MISMATCH. A rejected amend leaves the book unchanged.
+    template <typename Book>
+    TradeList amend(Book& book, OrderID id, Quantity quantity, Price price, OwnerID account, Timestamp now,
+                    RiskReject* reject = nullptr);
+
+    // Applies fills, to whichever tracked orders they touch.
+    void onTrades(const TradeList& trades);
+    // Brings one tracked order in line with the book after it was cancelled,
+    // reduced or replaced there.
+    template <typename Book>
+    void sync(const Book& book, OrderID id);
+    // Cancels every resting order of the account on the book and releases
+    // its open exposure; the position stays. Returns how many the book
+    // cancelled.
+    template <typename Book>
+    std::size_t cancelAccount(Book& book, OwnerID account);
+
+    // Forgets every account's exposure and every tracked order; limits stay.
+    void reset();
+    std::size_t trackedOrderCount() const;
+
+private:
+    struct Account;
+
+    // An order the gate has accepted and not yet seen leave the book.
+    // Per-account lists run through these; map nodes never move.
+    struct OpenOrder {
+        OrderID id;
+        Account* account;
+        OrderSide side;
+        Price price;  // 0 for market orders, which never rest
+        Quantity remaining;
+        OpenOrder* prev = nullptr;
+        OpenOrder* next = nullptr;
+    };
+
+    struct Account {
+        RiskLimits limits;
+        RiskExposure exposure;
+        OpenOrder* head = nullptr;
+    };
+
+    using OpenOrders = std::pmr::unordered_map<OrderID, OpenOrder>;
+
+    Account& account(OwnerID account);
+    void countOrder(Account& owner, Timestamp now);
+    OpenOrders::iterator admit(const Order& order, OwnerID account, Timestamp now);
+    RiskReject replace(OpenOrders::iterator it, const Order& replacement, OwnerID account, Timestamp now);
+    void fill(OrderID id, OrderSide side, Quantity quantity);
+    void settle(OpenOrders::iterator it, const Order* resting, bool queued);
+    void update(OpenOrder& open, Quantity remaining, Price price);
+    void release(OpenOrders::iterator it);
+
+    template <typename Book>
+    void watchBatches(Book& book);
+
+    RiskLimits defaultLimits_;
+    std::pmr::unordered_map<OwnerID, Account> accounts_;
+    OpenOrders open_;
+    // Dropped by a batch clear; released once the clear's fills are in.
+    std::pmr::vector<OrderID> dropped_;
+};
+
+template <typename Book>
+TradeList RiskGate::submit(Book& book, Order& order, OwnerID account, Timestamp now, RiskReject* reject) {
+    RiskReject result = book.hasLiveOrder(order.getOrderId()) ? RiskReject::DUPLICATE_ORDER_ID
+                                                               : check(order, account, now);
+    if (reject != nullptr) {
+        *reject = result;
+    }
+    if (result != RiskReject::NONE) {
+        order.setStatus(OrderStatus::CANCELLED);
+        return TradeList();
+    }
+    // Tracked at full size before matching, so the incoming side of each
+    // trade is applied by onTrades like any other.
+    OpenOrders::iterator open = admit(order, account, now);
+    watchBatches(book);
+    TradeList trades = book.addOrder(order, account);
+    onTrades(trades);
+    // onTrades only releases the entry on a complete fill. A batch that
+    // clears here does not update `order`, so then look again.
+    bool queued = false;
+    if (book.batching()) {
+        open = open_.find(order.getOrderId());
+        if (open == open_.end()) {
+            return trades;
+        }
+        queued = order.getStatus() == OrderStatus::OPEN;
+    } else if (order.getStatus() == OrderStatus::FILLED) {
+        return trades;
+    }
+    const Order* resting = book.getOrder(order.getOrderId());
+    settle(open, resting, queued && resting == nullptr);
+    return trades;
+}
+
+template <typename Book>
+TradeList RiskGate::amend(Book& book, OrderID id, Quantity quantity, Price price, OwnerID account, Timestamp now,
+                          RiskReject* reject) {
+    RiskReject result = RiskReject::NONE;
+    const Order* resting = book.getOrder(id);
+    if (resting != nullptr && book.getOwner(id) != account) {
+        result = RiskReject::ACCOUNT_MISMATCH;
+    } else if (resting != nullptr && quantity > 0 &&
+               (price != resting->getPrice() || quantity > resting->getQuantity())) {
+        Order replacement(id, quantity, price, resting->getType(), resting->getSide(), resting->getDuration(),
+                          resting->getIsPersonalOrder());
+        result = replace(open_.find(id), replacement, account, now);
+    }
+    if (reject != nullptr) {
+        *reject = result;
+    }
+    if (result != RiskReject::NONE) {
+        return TradeList();
+    }
+    watchBatches(book);
+    TradeList trades = book.amendOrder(id, quantity, price);
+    onTrades(trades);
+    auto open = open_.find(id);
+    if (open != open_.end()) {
+        const Order* amended = book.getOrder(id);
+        settle(open, amended, book.batching() && amended == nullptr);
+    }
+    return trades;
+}
+
+template <typename Book>
+void RiskGate::sync(const Book& book, OrderID id) {
+    auto found = open_.find(id);
+    if (found != open_.end()) {
+        settle(found, book.getOrder(id), false);
+    }
+}
+
+template <typename Book>
+std::size_t RiskGate::cancelAccount(Book& book, OwnerID account) {
+    std::size_t cancelled = book.cancelOwner(account);
+    auto found = accounts_.find(account);
+    if (found != accounts_.end()) {
+        while (found->second.head != nullptr) {
+            release(open_.find(found->second.head->id));
+        }
+    }
+    return cancelled;
+}
+
+template <typename Book>
+void RiskGate::watchBatches(Book& book) {
+    if (book.batching()) {
+        book.setBatchDropHandler([this](OrderID id) { dropped_.push_back(id); });
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Occupancy of a fixed range of slots as a hierarchy of 64-bit words: bit i
+// of level 0 says slot i is set, and bit j of level k+1 says word j of level
+// k is non-zero. Finding the first set slot at or after any position takes
+// one count-trailing-zeros per level on the way up and down, however wide
+// the run of empty slots in between; three levels cover 262144 slots.
+class TickBitmap {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit TickBitmap(std::size_t slots = 0) {
+        resize(slots);
+    }
+
+    // Clears every slot.
+    void resize(std::size_t slots) {
+        slots_ = slots;
+        levels_.clear();
+        std::size_t words = wordsFor(slots);
+        do {
+            levels_.emplace_back(words, 0);
+            words = wordsFor(words);
+        } while (levels_.back().size() > 1);
+    }
+
+    std::size_t size() const {
+        return slots_;
+    }
+
+    bool test(std::size_t slot) const {
+        return (levels_[0][slot >> 6] >> (slot & 63)) & 1;
+    }
+
+    void set(std::size_t slot) {
+        for (std::vector<std::uint64_t>& level : levels_) {
+            std::uint64_t& word = level[slot >> 6];
+            bool wasEmpty = word == 0;
+            word |= std::uint64_t(1) << (slot & 63);
+            if (!wasEmpty) {
+                return;
+            }
+            slot >>= 6;
+        }
+    }
+
+    void reset(std::size_t slot) {
+        for (std::vector<std::uint64_t>& level : levels_) {
+            std::uint64_t& word = level[slot >> 6];
+            word &= ~(std::uint64_t(1) << (slot & 63));
+            if (word != 0) {
+                return;
+            }
+            slot >>= 6;
+        }
+    }
+
+    bool none() const {
+        return levels_.back()[0] == 0;
+    }
+
+    std::size_t findFirst() const {
+        return findNext(0);
+    }
+
+    // First set slot at or after `slot`, or npos.
+    std::size_t findNext(std::size_t slot) const {
+        if (slot >= slots_) {
+            return npos;
+        }
+        // Climb while the rest of the current word is empty...
+        std::size_t level = 0;
+        std::size_t index = slot;
+        while (true) {
+            std::uint64_t word = levels_[level][index >> 6] & (~std::uint64_t(0) << (index & 63));
+            if (word != 0) {
+                index = (index & ~std::size_t(63)) | __builtin_ctzll(word);
+                break;
+            }
+            if (++level == levels_.size()) {
+                return npos;
+            }
+            index = (index >> 6) + 1;
+            if ((index >> 6) >= levels_[level].size()) {
+                return npos;
+            }
+        }
+        // ...then descend through the first set bit of each word.
+        while (level-- > 0) {
+            index = (index << 6) | __builtin_ctzll(levels_[level][index]);
+        }
+        return index;
+    }
+
+private:
+    static std::size_t wordsFor(std::size_t bits) {
+        return bits == 0 ? 1 : (bits + 63) / 64;
+    }
+
+    std::size_t slots_ = 0;
+    std::vector<std::vector<std::uint64_t>> levels_;  // levels_[0] is per slot
+};
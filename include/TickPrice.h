@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "types.h"
+
+// A price held as a whole number of ticks in `Rep`, for instruments whose
+// prices all lie on a fixed grid of TicksPerUnit ticks per unit of Price.
+// Two of these compare as integers; anywhere else one converts to Price
+// (ticks / TicksPerUnit, which is the same double a parse of the decimal
+// price gives), so a book keyed by TickPrice reads like one keyed by Price.
+// Construction from a Price is explicit because it rounds.
+template <typename Rep, std::int64_t TicksPerUnit>
+class TickPrice {
+public:
+    static_assert(std::numeric_limits<Rep>::is_integer, "TickPrice needs an integer representation");
+    static_assert(TicksPerUnit > 0, "TicksPerUnit must be positive");
+
+    TickPrice() = default;
+    explicit TickPrice(Price price) : ticks_(static_cast<Rep>(std::llround(price * TicksPerUnit))) {}
+
+    operator Price() const { return static_cast<Price>(ticks_) / TicksPerUnit; }
+    Rep ticks() const { return ticks_; }
+
+    // True if `price` lies on the grid and its tick count fits in Rep.
+    static bool representable(Price price) {
+        double scaled = price * TicksPerUnit;
+        double rounded = std::nearbyint(scaled);
+        return std::abs(scaled - rounded) < 1e-6 &&
+               rounded >= static_cast<double>(std::numeric_limits<Rep>::min()) &&
+               rounded <= static_cast<double>(std::numeric_limits<Rep>::max());
+    }
+
+    friend bool operator==(TickPrice a, TickPrice b) { return a.ticks_ == b.ticks_; }
+    friend bool operator!=(TickPrice a, TickPrice b) { return a.ticks_ != b.ticks_; }
+    friend bool operator<(TickPrice a, TickPrice b) { return a.ticks_ < b.ticks_; }
+    friend bool operator>(TickPrice a, TickPrice b) { return a.ticks_ > b.ticks_; }
+    friend bool operator<=(TickPrice a, TickPrice b) { return a.ticks_ <= b.ticks_; }
+    friend bool operator>=(TickPrice a, TickPrice b) { return a.ticks_ >= b.ticks_; }
+
+private:
+    Rep ticks_ = 0;
+};
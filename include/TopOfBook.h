@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "types.h"
+
+struct BookLevel {
+    Price price;
+    Quantity quantity;
+};
+
+// The best few levels of each side plus the last trade, as published for
+// readers on other threads. Plain data so it can be copied word by word.
+struct TopOfBook {
+    static constexpr std::size_t DEPTH = 5;
+
+    std::uint64_t sequence = 0;  // publications so far; 0 if none yet
+    std::uint32_t bidCount = 0;  // filled entries of bids/asks
+    std::uint32_t askCount = 0;
+    BookLevel bids[DEPTH] = {};  // best first
+    BookLevel asks[DEPTH] = {};
+    Price lastTradePrice = 0.0;
+    Quantity lastTradeQuantity = 0;
+
+    Price bestBid() const { return bidCount ? bids[0].price : Price(); }
+    Price bestAsk() const { return askCount ? asks[0].price : Price(); }
+    Price midPrice() const { return bidCount && askCount ? (bids[0].price + asks[0].price) / 2 : Price(); }
+};
+
+// Seqlock around one TopOfBook: a single writer (the matching thread)
+// publishes, and any number of readers take consistent copies without
+// locking or writing shared memory, so they never contend with the writer
+// or each other for a cache line. A reader that overlaps a publish retries.
+// The payload is stored as relaxed atomic words so concurrent access is
+// well-defined; the sequence is odd while a publish is in progress.
+class TopOfBookPublisher {
+public:
+    // Single writer only. Stamps the snapshot's sequence number; a snapshot
+    // with no trade keeps the last published trade.
+    void publish(TopOfBook top) {
+        if (top.lastTradeQuantity == 0) {
+            top.lastTradePrice = lastTradePrice_;
+            top.lastTradeQuantity = lastTradeQuantity_;
+        }
+        lastTradePrice_ = top.lastTradePrice;
+        lastTradeQuantity_ = top.lastTradeQuantity;
+
+        std::uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        top.sequence = seq / 2 + 1;
+        std::uint64_t words[WORDS];
+        std::memcpy(words, &top, sizeof(top));
+
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any thread. The latest complete snapshot (sequence 0 before the first
+    // publish).
+    TopOfBook read() const {
+        std::uint64_t words[WORDS];
+        while (true) {
+            std::uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        TopOfBook top;
+        std::memcpy(&top, words, sizeof(top));
+        return top;
+    }
+
+private:
+    static_assert(std::is_trivially_copyable<TopOfBook>::value, "TopOfBook is copied as raw words");
+    static_assert(sizeof(TopOfBook) % sizeof(std::uint64_t) == 0, "TopOfBook must be a whole number of words");
+    static constexpr std::size_t WORDS = sizeof(TopOfBook) / sizeof(std::uint64_t);
+
+    alignas(64) std::atomic<std::uint64_t> sequence_{0};
+    alignas(64) std::atomic<std::uint64_t> data_[WORDS] = {};
+    // Writer-only state, kept off the lines readers load.
+    alignas(64) Price lastTradePrice_ = 0.0;
+    Quantity lastTradeQuantity_ = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "OrderGenerator.h"
+#include "Orderbook.h"
+#include "Portfolio.h"
+#include "Random.h"
+#include "RiskGate.h"
+#include "WorkloadGenerator.h"
+
+class TradingEngine {
+public:
+    // Account the engine's own orders are checked and rest under.
+    static constexpr OwnerID PERSONAL_ACCOUNT = 1;
+    static constexpr Timestamp SIMULATION_STEP = 1000000;  // 1 ms per iteration
+
+    // The same seed replays the same simulation; initialize() rewinds to it.
+    explicit TradingEngine(std::uint64_t seed = OrderGenerator::DEFAULT_SEED);
+
+    void initialize();
+    void runSimulation(int numIterations);
+    void processOrder(Order& order);
+    // Goes through riskGate_ first, at the engine's clock; a rejected order
+    // comes back CANCELLED.
+    void processPersonalOrder(Order& order);
+    // Moves the clock to the command's timestamp before applying it.
+    void processCommand(OrderCommand& command);
+
+    const TradeList& getTradeHistory() const;
+    const std::vector<double>& getPortfolioValues() const;
+
+    Orderbook orderbook_;
+    RiskGate riskGate_;  // unlimited until limits are set; initialize() keeps them
+    TradeList tradeHistory_;
+    Portfolio portfolio_;
+    std::vector<double> portfolioValues_;
+    OrderID nextOrderID_;
+    // Simulated time (ns) for the risk gate's rate window, never the wall
+    // clock, so a replay makes the same decisions. Command timestamps move
+    // it forward and each simulation iteration adds SIMULATION_STEP.
+    Timestamp clock_;
+    std::uint64_t seed_;
+    OrderGenerator orderGenerator_;
+    Xoshiro256 rng_;
+};
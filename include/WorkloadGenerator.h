@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Order.h"
+#include "Orderbook.h"
+#include "Random.h"
+#include "types.h"
+
+enum class CommandType : std::uint8_t { NEW, CANCEL, AMEND };
+
+// One message in a workload. NEW carries the full order; CANCEL only uses
+// order.getOrderId(); AMEND uses the ID plus the new quantity and price.
+struct OrderCommand {
+    CommandType type = CommandType::NEW;
+    Timestamp timestamp = 0;  // nanoseconds since the start of the workload
+    Order order;
+};
+
+struct WorkloadConfig {
+    std::uint64_t seed = 1;
+    Price initialMidPrice = 100.0;
+    Price tickSize = 0.01;
+
+    // Arrivals follow a Hawkes process: a base Poisson rate plus
+    // self-excitation that decays exponentially. branchingRatio = 0 gives
+    // plain Poisson arrivals; values near 1 give heavy bursts.
+    double baseRatePerSecond = 100000.0;
+    double branchingRatio = 0.7;
+    double decayPerSecond = 5000.0;
+
+    // Message mix. Until minLiveOrders resting orders are live every message
+    // is a new order, which builds the book up first. Cancels can only retire
+    // what new orders add, so a stable book needs cancelRatio near the share
+    // of new resting orders; amends make up the rest of the ~90% churn.
+    double cancelRatio = 0.15;
+    double amendRatio = 0.75;
+    std::size_t minLiveOrders = 1000;
+
+    // Mix of new orders. Market orders ignore price.
+    double marketRatio = 0.02;
+    double immediateOrCancelRatio = 0.05;
+    double fillOrKillRatio = 0.01;
+
+    // Passive orders rest a geometric number of ticks behind the touch
+    // with this mean; aggressive ones cross by the same distribution.
+    double meanTicksFromTouch = 2.0;
+    double aggressiveRatio = 0.05;
+    double midDriftTicks = 0.2;  // standard deviation of the per-message mid random walk
+
+    // Sizes are Pareto(minSize, sizeTailExponent), capped at maxSize.
+    Quantity minSize = 1;
+    Quantity maxSize = 10000;
+    double sizeTailExponent = 1.5;
+};
+
+// Produces realistic, reproducible order-flow command streams. The generator
+// remembers the IDs of the resting orders it has sent so cancels and amends
+// target live orders; ones that have since traded are rejected by the book,
+// just as a real venue would.
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& config = WorkloadConfig(), OrderID firstOrderID = 1);
+
+    OrderCommand next();
+    void generateInto(OrderCommand* commands, std::size_t count);
+    std::vector<OrderCommand> generate(std::size_t count);
+
+    const WorkloadConfig& config() const;
+    std::size_t liveOrderCount() const;
+
+private:
+    Timestamp nextArrival();
+    OrderCommand makeNew();
+    OrderCommand makeCancel();
+    OrderCommand makeAmend();
+    Quantity drawSize();
+    std::int64_t drawTicksFromTouch();
+    Price priceAtTicks(std::int64_t ticksFromMid, OrderSide side) const;
+    std::size_t pickLive();
+
+    WorkloadConfig config_;
+    Xoshiro256 rng_;
+    OrderID nextOrderID_;
+    double midTicks_;
+    double timeSeconds_ = 0.0;
+    double excitation_ = 0.0;
+    // Live IDs in a flat vector with swap-remove, so picking and retiring a
+    // random victim are both O(1).
+    std::vector<OrderID> live_;
+    std::vector<OrderSide> liveSides_;
+};
+
+// Applies a command to a book and returns any trades. Amends that only
+// shrink quantity at the same price keep queue priority; anything else is a
+// cancel/replace. Cancels and amends of unknown IDs are no-ops. A batching
+// book's clock follows the command timestamps.
+TradeList applyCommand(Orderbook& book, OrderCommand& command);
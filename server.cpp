@@ -1,17 +1,59 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <cstring>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <limits>
 
 #include "Orderbook.h"
+#include "BinaryProtocol.h"
+#include "OrderJson.h"
+#include "LatencyProbe.h"
+#include "TopOfBook.h"
+#include "DepthSnapshot.h"
+#include "RiskGate.h"
 
 Orderbook book;
 std::vector<Trade> tradeHistory;
+// Pre-trade limits for every order entered over HTTP or a binary session.
+// Also guarded by bookMutex, and shown every trade the book makes.
+RiskGate riskGate;
+// Guards book, tradeHistory and riskGate, which are shared by the HTTP loop
+// and the binary order-entry sessions.
+std::mutex bookMutex;
+// Best levels and last trade of `book`, readable without bookMutex.
+TopOfBookPublisher topOfBookFeed;
+// Full-depth snapshots of `book`, also readable without bookMutex.
+DepthSnapshotPublisher depthFeed;
+
+const int HTTP_PORT = 8080;
+const int BINARY_PORT = 9090;
+// How often a changed book is republished to depthFeed.
+const std::chrono::milliseconds DEPTH_SNAPSHOT_INTERVAL(50);
+// Limits every account starts with: order size, open notional, net position
+// and orders per second.
+const RiskLimits SESSION_RISK_LIMITS{1000000, 1e9, 10000000, 50000};
+// Next account handed to a binary session.
+std::atomic<OwnerID> nextSessionAccount(1);
+// The one account all HTTP orders share; binary sessions count up from 1 and
+// never reach it.
+const OwnerID HTTP_ACCOUNT = std::numeric_limits<OwnerID>::max();
+
+Timestamp steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 std::string serializeOrderbookToJson(const Orderbook& book) {
     // Build JSON string for { "bids": [ {price, quantity}, ... ], "asks": [...] }
@@ -34,10 +76,7 @@ std::string serializeOrderbookToJson(const Orderbook& book) {
         bool firstPrice = true;
         for (auto &bidPair : book.getBids()) {
             Price p = bidPair.first;
-            Quantity totalQty = 0;
-            for (auto &ord : bidPair.second) {
-                totalQty += ord.getQuantity();
-            }
+            Quantity totalQty = bidPair.second.totalQuantity();
             if (!firstPrice) ss << ",";
             ss << "{ \"price\":" << p << ", \"quantity\":" << totalQty << "}";
             firstPrice = false;
@@ -48,10 +87,7 @@ std::string serializeOrderbookToJson(const Orderbook& book) {
         bool firstPrice = true;
         for (auto &askPair : book.getAsks()) {
             Price p = askPair.first;
-            Quantity totalQty = 0;
-            for (auto &ord : askPair.second) {
-                totalQty += ord.getQuantity();
-            }
+            Quantity totalQty = askPair.second.totalQuantity();
             if (!firstPrice) ss << ",";
             ss << "{ \"price\":" << p << ", \"quantity\":" << totalQty << "}";
             firstPrice = false;
@@ -78,6 +114,56 @@ std::string serializeTradesToJson(const std::vector<Trade>& trades) {
     return ss.str();
 }
 
+std::string serializeTopOfBookToJson(const TopOfBook& top) {
+    std::ostringstream ss;
+    ss << "{ \"sequence\":" << top.sequence << ", \"bids\": [";
+    for (std::uint32_t i = 0; i < top.bidCount; ++i) {
+        if (i) ss << ",";
+        ss << "{ \"price\":" << top.bids[i].price << ", \"quantity\":" << top.bids[i].quantity << "}";
+    }
+    ss << "], \"asks\": [";
+    for (std::uint32_t i = 0; i < top.askCount; ++i) {
+        if (i) ss << ",";
+        ss << "{ \"price\":" << top.asks[i].price << ", \"quantity\":" << top.asks[i].quantity << "}";
+    }
+    ss << "], \"lastTrade\": { \"price\":" << top.lastTradePrice
+       << ", \"quantity\":" << top.lastTradeQuantity << "} }";
+    return ss.str();
+}
+
+std::string serializeDepthSnapshotToJson(const DepthSnapshot* snapshot) {
+    std::ostringstream ss;
+    ss << "{ \"sequence\":" << (snapshot ? snapshot->sequence : 0) << ", \"bids\": [";
+    if (snapshot) {
+        for (size_t i = 0; i < snapshot->bids->size(); ++i) {
+            const BookLevel& level = (*snapshot->bids)[i];
+            if (i) ss << ",";
+            ss << "{ \"price\":" << level.price << ", \"quantity\":" << level.quantity << "}";
+        }
+    }
+    ss << "], \"asks\": [";
+    if (snapshot) {
+        for (size_t i = 0; i < snapshot->asks->size(); ++i) {
+            const BookLevel& level = (*snapshot->asks)[i];
+            if (i) ss << ",";
+            ss << "{ \"price\":" << level.price << ", \"quantity\":" << level.quantity << "}";
+        }
+    }
+    ss << "] }";
+    return ss.str();
+}
+
+// Republishes the top of book after a change. Must be called with bookMutex
+// held, which keeps the feed to a single writer.
+void publish_top(const TradeList& trades) {
+    TopOfBook top = book.topOfBook();
+    if (!trades.empty()) {
+        top.lastTradePrice = trades.back().getPrice();
+        top.lastTradeQuantity = trades.back().getTradedQuantity();
+    }
+    topOfBookFeed.publish(top);
+}
+
 std::string read_request_body(int client_fd, size_t content_length) {
     std::string body;
     body.resize(content_length);
@@ -104,6 +190,129 @@ size_t get_content_length(const std::string& request) {
     return 0;
 }
 
+// Sends the whole buffer, retrying on short writes.
+bool send_all(int fd, const char* data, size_t length) {
+    LATENCY_PROBE(ProbePoint::SEND);
+    size_t total_sent = 0;
+    while (total_sent < length) {
+        ssize_t n = send(fd, data + total_sent, length - total_sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        total_sent += n;
+    }
+    return true;
+}
+
+const size_t NDJSON_CHUNK_SIZE = 256 * 1024;
+
+// Parses every complete line in pending[0, end) into batch and submits the
+// whole batch under a single lock, appending one [orderId, status, filled]
+// entry per line to results. Malformed lines are reported as
+// [null, "REJECTED", 0] so results stay aligned with the request body, and
+// orders the risk gate refuses, a still-live ID included, as
+// [orderId, "REJECTED", 0].
+void submit_ndjson_lines(const std::string& pending, size_t end, std::vector<Order>& batch,
+                         std::vector<bool>& valid, std::string& results) {
+    batch.clear();
+    valid.clear();
+    std::string_view lines(pending.data(), end);
+    size_t pos = 0;
+    while (pos < lines.size()) {
+        size_t lineEnd = lines.find('\n', pos);
+        if (lineEnd == std::string_view::npos) lineEnd = lines.size();
+        std::string_view line = lines.substr(pos, lineEnd - pos);
+        pos = lineEnd + 1;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+
+        PROBE_BEGIN(parseStart);
+        batch.emplace_back();
+        valid.push_back(parseOrderJson(line, batch.back()));
+        PROBE_END(parseStart, ProbePoint::PARSE);
+    }
+
+    std::lock_guard<std::mutex> lock(bookMutex);
+    TradeList lastTrades;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (results.size() > 1) results += ',';
+        if (!valid[i]) {
+            results += "[null,\"REJECTED\",0]";
+            continue;
+        }
+        Order& order = batch[i];
+        RiskReject reject = RiskReject::NONE;
+        TradeList trades = riskGate.submit(book, order, HTTP_ACCOUNT, steady_now_ns(), &reject);
+        if (reject != RiskReject::NONE) {
+            results += '[';
+            results += std::to_string(order.getOrderId());
+            results += ",\"REJECTED\",0]";
+            continue;
+        }
+        tradeHistory.insert(tradeHistory.end(), trades.begin(), trades.end());
+        if (!trades.empty()) lastTrades.swap(trades);
+
+        LATENCY_PROBE(ProbePoint::SERIALIZE);
+        results += '[';
+        results += std::to_string(order.getOrderId());
+        results += ",\"";
+        results += orderStatusName(order.getStatus());
+        results += "\",";
+        results += std::to_string(order.getFilledQuantity());
+        results += ']';
+    }
+    // Once per batch rather than per order: readers only need the latest state.
+    publish_top(lastTrades);
+}
+
+// POST /addOrders: the body is newline-delimited JSON orders. The body is
+// consumed in fixed-size chunks and each chunk's complete lines are submitted
+// as one batch, so memory stays bounded however large the upload is.
+void handle_add_orders(int client_fd, const std::string& request_str) {
+    size_t content_length = get_content_length(request_str);
+    size_t header_end = request_str.find("\r\n\r\n");
+    std::string pending;
+    if (header_end != std::string::npos) {
+        pending = request_str.substr(header_end + 4);
+    }
+    if (pending.size() > content_length) pending.resize(content_length);
+    size_t remaining = content_length - pending.size();
+
+    std::vector<Order> batch;
+    std::vector<bool> valid;
+    std::string results = "[";
+
+    while (true) {
+        if (remaining > 0) {
+            size_t offset = pending.size();
+            size_t want = std::min(remaining, NDJSON_CHUNK_SIZE);
+            pending.resize(offset + want);
+            ssize_t r = read(client_fd, &pending[offset], want);
+            if (r <= 0) {
+                pending.resize(offset);
+                remaining = 0;
+            } else {
+                pending.resize(offset + r);
+                remaining -= r;
+            }
+        }
+
+        // Only complete lines are submitted until the body is exhausted.
+        size_t end = pending.size();
+        if (remaining > 0) {
+            size_t lastNewline = pending.rfind('\n');
+            end = (lastNewline == std::string::npos) ? 0 : lastNewline + 1;
+        }
+        if (end > 0) {
+            submit_ndjson_lines(pending, end, batch, valid, results);
+            pending.erase(0, end);
+        }
+        if (remaining == 0) break;
+    }
+    results += ']';
+
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                           std::to_string(results.size()) + "\r\n\r\n" + results;
+    send_all(client_fd, response.data(), response.size());
+}
+
 void handle_request(int client_fd) {
     char buffer[4096] = {0};
     int bytes_read = read(client_fd, buffer, sizeof(buffer));
@@ -117,12 +326,29 @@ void handle_request(int client_fd) {
     std::string method, path, http_version;
     request_stream >> method >> path >> http_version;
 
-    if (method == "GET" && path == "/orderbook") {
+    if (method == "GET" && path == "/top") {
+        // Lock-free: a snapshot as of the last change, never blocking matching.
+        std::string top_json = serializeTopOfBookToJson(topOfBookFeed.read());
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + top_json;
+        send_all(client_fd, response.data(), response.size());
+    } else if (method == "GET" && path == "/depth") {
+        // Lock-free full ladder, at most DEPTH_SNAPSHOT_INTERVAL old.
+        DepthSnapshotPublisher::Snapshot snapshot = depthFeed.acquire();
+        std::string depth_json = serializeDepthSnapshotToJson(snapshot.get());
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + depth_json;
+        send_all(client_fd, response.data(), response.size());
+    } else if (method == "GET" && path == "/orderbook") {
+        std::unique_lock<std::mutex> lock(bookMutex);
+        PROBE_BEGIN(serializeStart);
         std::string orderbook_json = serializeOrderbookToJson(book);
+        PROBE_END(serializeStart, ProbePoint::SERIALIZE);
+        lock.unlock();
         std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + orderbook_json;
-        send(client_fd, response.c_str(), response.size(), 0);
+        send_all(client_fd, response.data(), response.size());
     } else if (method == "GET" && path == "/trades") {
+        std::unique_lock<std::mutex> lock(bookMutex);
         std::string trades_json = serializeTradesToJson(tradeHistory);
+        lock.unlock();
         std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + trades_json;
         send(client_fd, response.c_str(), response.size(), 0);
     } else if (method == "POST" && path == "/addOrder") {
@@ -132,6 +358,7 @@ void handle_request(int client_fd) {
             body = read_request_body(client_fd, content_length);
         }
 
+        PROBE_BEGIN(parseStart);
         // Parse JSON 
         // { "orderId": 123, "price":100.5, "quantity":200, "side":"BUY", "type":"LIMIT", "duration":"GOOD_TIL_CANCEL" }
         OrderID orderId = 0;
@@ -179,21 +406,45 @@ void handle_request(int client_fd) {
 
         // Construct the order and add it
         Order newOrder(orderId, quantity, price, type, side, duration, isPersonal);
-        TradeList trades = book.addOrder(newOrder);
+        PROBE_END(parseStart, ProbePoint::PARSE);
+        std::unique_lock<std::mutex> lock(bookMutex);
+        // The gate also refuses an ID that is still live (DUPLICATE_ORDER_ID).
+        RiskReject reject = RiskReject::NONE;
+        TradeList trades = riskGate.submit(book, newOrder, HTTP_ACCOUNT, steady_now_ns(), &reject);
+        if (reject != RiskReject::NONE) {
+            lock.unlock();
+            std::string response_body = std::string("{ \"rejected\": \"") + riskRejectName(reject) + "\" }";
+            std::string response = "HTTP/1.1 422 Unprocessable Entity\r\nContent-Type: application/json\r\n\r\n" +
+                                   response_body;
+            send_all(client_fd, response.data(), response.size());
+            close(client_fd);
+            return;
+        }
 
         // Append these trades to the global tradeHistory
         for (auto &t : trades) {
             tradeHistory.push_back(t);
         }
+        publish_top(trades);
 
         // Return the updated orderbook and trades in one response
+        PROBE_BEGIN(serializeStart);
         std::string orderbook_json = serializeOrderbookToJson(book);
         std::string trades_json = serializeTradesToJson(tradeHistory);
+        PROBE_END(serializeStart, ProbePoint::SERIALIZE);
+        lock.unlock();
 
         std::string response_body = "{ \"orderbook\": " + orderbook_json + ", \"trades\": " + trades_json + " }";
 
         std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + response_body;
-        send(client_fd, response.c_str(), response.size(), 0);
+        send_all(client_fd, response.data(), response.size());
+    } else if (method == "POST" && path == "/addOrders") {
+        handle_add_orders(client_fd, request_str);
+    } else if (method == "GET" && path == "/metrics") {
+        std::string metrics = renderProbeMetrics();
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(metrics.size()) + "\r\n\r\n" + metrics;
+        send_all(client_fd, response.data(), response.size());
     } else {
         // 404
         std::string response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n\r\nRoute not found!";
@@ -203,13 +454,212 @@ void handle_request(int client_fd) {
     close(client_fd);
 }
 
-int main() {
-    std::cout << "Created Orderbook\n";
+void append_report(std::string& out, const binary::ExecutionReport& report) {
+    LATENCY_PROBE(ProbePoint::SERIALIZE);
+    size_t offset = out.size();
+    out.resize(offset + sizeof(report));
+    binary::encode(report, &out[offset]);
+}
+
+void reject_binary_request(uint64_t clientSeq, uint64_t orderId, std::string& out) {
+    binary::ExecutionReport report{};
+    report.msgType = binary::MessageType::EXECUTION_REPORT;
+    report.reportType = binary::ReportType::REJECTED;
+    report.clientSeq = clientSeq;
+    report.orderId = orderId;
+    append_report(out, report);
+}
+
+// Reports every fill of an order that has just reached the book with
+// `originalQuantity`, then its final state: `restingReport` if some quantity
+// rests on the book, DONE if fully filled, CANCELLED otherwise. `order` is
+// its state after matching. Must be called with bookMutex held.
+void report_binary_order(const Order& order, Quantity originalQuantity, const TradeList& trades, uint64_t clientSeq,
+                         binary::ReportType restingReport, std::string& out) {
+    tradeHistory.insert(tradeHistory.end(), trades.begin(), trades.end());
+    publish_top(trades);
+
+    Quantity cumQuantity = 0;
+    for (const Trade& trade : trades) {
+        bool isBuy = order.getSide() == OrderSide::BUY;
+        const TradeChild& counterparty = isBuy ? trade.getSellOrder() : trade.getBuyOrder();
+        cumQuantity += trade.getTradedQuantity();
+
+        binary::ExecutionReport report = binary::makeReport(binary::ReportType::FILL, clientSeq, order);
+        report.counterpartyOrderId = counterparty.orderID;
+        report.lastQuantity = trade.getTradedQuantity();
+        report.lastPrice = trade.getPrice();
+        report.cumQuantity = cumQuantity;
+        report.leavesQuantity = originalQuantity - cumQuantity;
+        append_report(out, report);
+    }
+
+    const Order* resting = book.getOrder(order.getOrderId());
+    binary::ReportType finalType = restingReport;
+    if (resting == nullptr) {
+        finalType = cumQuantity == originalQuantity ? binary::ReportType::DONE : binary::ReportType::CANCELLED;
+    }
+    binary::ExecutionReport report = binary::makeReport(finalType, clientSeq, order);
+    report.leavesQuantity = resting ? resting->getQuantity() : 0;
+    append_report(out, report);
+}
+
+// Submits through the risk gate and reports as report_binary_order does, or
+// REJECTED if the gate refused the order. Must be called with bookMutex held.
+void submit_binary_order(Order& order, OwnerID account, uint64_t clientSeq, binary::ReportType restingReport,
+                         std::string& out) {
+    Quantity originalQuantity = order.getQuantity();
+    RiskReject reject = RiskReject::NONE;
+    TradeList trades = riskGate.submit(book, order, account, steady_now_ns(), &reject);
+    if (reject != RiskReject::NONE) {
+        reject_binary_request(clientSeq, order.getOrderId(), out);
+        return;
+    }
+    report_binary_order(order, originalQuantity, trades, clientSeq, restingReport, out);
+}
+
+// A NEW for an ID that is still resting is rejected rather than replacing
+// that order's index entry.
+void handle_binary_new(const binary::NewOrderMessage& msg, OwnerID account, std::string& out) {
+    if (!binary::isValid(msg)) {
+        reject_binary_request(msg.clientSeq, msg.orderId, out);
+        return;
+    }
+    Order order = binary::toOrder(msg);
+    std::lock_guard<std::mutex> lock(bookMutex);
+    if (book.hasLiveOrder(msg.orderId)) {
+        reject_binary_request(msg.clientSeq, msg.orderId, out);
+        return;
+    }
+    submit_binary_order(order, account, msg.clientSeq, binary::ReportType::ACCEPTED, out);
+}
 
+// A session may only cancel or amend orders resting under its own account.
+void handle_binary_cancel(const binary::CancelOrderMessage& msg, OwnerID account, std::string& out) {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    const Order* resting = book.getOrder(msg.orderId);
+    if (resting == nullptr || book.getOwner(msg.orderId) != account) {
+        reject_binary_request(msg.clientSeq, msg.orderId, out);
+        return;
+    }
+    Order cancelled = *resting;
+    OrderID orderId = msg.orderId;
+    book.cancelOrder(orderId);
+    riskGate.sync(book, orderId);
+    publish_top({});
+    cancelled.setStatus(OrderStatus::CANCELLED);
+    append_report(out, binary::makeReport(binary::ReportType::CANCELLED, msg.clientSeq, cancelled));
+}
+
+// Reducing quantity at the same price keeps queue priority and is applied in
+// place; any other change is a cancel/replace that goes to the back of the queue.
+// A replacement is checked before the original is cancelled, so with the
+// original still counted; if the risk gate refuses it the original stays.
+void handle_binary_amend(const binary::AmendOrderMessage& msg, OwnerID account, std::string& out) {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    const Order* resting = book.getOrder(msg.orderId);
+    if (resting == nullptr || book.getOwner(msg.orderId) != account || msg.quantity <= 0) {
+        reject_binary_request(msg.clientSeq, msg.orderId, out);
+        return;
+    }
+
+    Order amended(msg.orderId, msg.quantity, msg.price, resting->getType(), resting->getSide(),
+                  resting->getDuration(), resting->getIsPersonalOrder());
+    RiskReject reject = RiskReject::NONE;
+    TradeList trades = riskGate.amend(book, msg.orderId, msg.quantity, msg.price, account, steady_now_ns(), &reject);
+    if (reject != RiskReject::NONE) {
+        reject_binary_request(msg.clientSeq, msg.orderId, out);
+        return;
+    }
+    // The book keeps only what rests; a replacement that left it is rebuilt
+    // from its trades.
+    if (const Order* current = book.getOrder(msg.orderId)) {
+        amended = *current;
+    } else {
+        Quantity filled = 0;
+        for (const Trade& trade : trades) {
+            filled += trade.getTradedQuantity();
+        }
+        amended.setFilledQuantity(filled);
+        amended.setStatus(filled == msg.quantity ? OrderStatus::FILLED : OrderStatus::CANCELLED);
+    }
+    report_binary_order(amended, msg.quantity, trades, msg.clientSeq, binary::ReportType::AMENDED, out);
+}
+
+// Serves one binary client until it disconnects. Every complete message in a
+// read is processed before the reports for that read are written back in a
+// single send, so pipelined clients pay one syscall per batch. The session is
+// its own account, and its resting orders are cancelled when it disconnects.
+void handle_binary_session(int client_fd) {
+    OwnerID account = nextSessionAccount++;
+    int nodelay = 1;
+    setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    std::vector<char> in(64 * 1024);
+    size_t buffered = 0;
+    std::string out;
+
+    while (true) {
+        ssize_t r = read(client_fd, in.data() + buffered, in.size() - buffered);
+        if (r <= 0) break;
+        buffered += r;
+
+        size_t pos = 0;
+        bool malformed = false;
+        while (pos < buffered) {
+            size_t size = binary::inboundMessageSize(static_cast<uint8_t>(in[pos]));
+            if (size == 0) {
+                malformed = true;
+                break;
+            }
+            if (buffered - pos < size) break;
+
+            const char* bytes = in.data() + pos;
+            switch (static_cast<binary::MessageType>(bytes[0])) {
+                case binary::MessageType::NEW_ORDER:
+                    handle_binary_new(binary::decode<binary::NewOrderMessage>(bytes), account, out);
+                    break;
+                case binary::MessageType::CANCEL_ORDER:
+                    handle_binary_cancel(binary::decode<binary::CancelOrderMessage>(bytes), account, out);
+                    break;
+                case binary::MessageType::AMEND_ORDER:
+                    handle_binary_amend(binary::decode<binary::AmendOrderMessage>(bytes), account, out);
+                    break;
+                default:
+                    break;
+            }
+            pos += size;
+        }
+
+        if (!out.empty()) {
+            if (!send_all(client_fd, out.data(), out.size())) break;
+            out.clear();
+        }
+        if (malformed) {
+            // Framing is lost once an unknown type byte arrives; drop the client.
+            break;
+        }
+
+        std::memmove(in.data(), in.data() + pos, buffered - pos);
+        buffered -= pos;
+    }
+
+    // Nothing can manage the session's orders once it is gone; the gate
+    // cancels them and releases the account's open exposure.
+    {
+        std::lock_guard<std::mutex> lock(bookMutex);
+        if (riskGate.cancelAccount(book, account) > 0) {
+            publish_top({});
+        }
+    }
+    close(client_fd);
+}
+
+int open_listener(int port) {
     int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd == 0) {
+    if (server_fd < 0) {
         perror("Socket creation failed");
-        return 1;
+        return -1;
     }
 
     int opt = 1;
@@ -218,22 +668,74 @@ int main() {
     sockaddr_in address{};
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(8080);
+    address.sin_port = htons(port);
 
     if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
         perror("Bind failed");
-        return 1;
+        close(server_fd);
+        return -1;
     }
 
-    if (listen(server_fd, 3) < 0) {
+    if (listen(server_fd, 16) < 0) {
         perror("Listen failed");
+        close(server_fd);
+        return -1;
+    }
+    return server_fd;
+}
+
+// Accepts binary order-entry clients; each gets its own session thread since
+// connections are long-lived, unlike the one-shot HTTP requests.
+void run_binary_listener(int server_fd) {
+    while (true) {
+        int client_fd = accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            perror("Accept failed");
+            continue;
+        }
+        std::thread(handle_binary_session, client_fd).detach();
+    }
+}
+
+// Republishes depthFeed at a fixed cadence. Only draining the book's depth
+// journal holds bookMutex, an O(1) swap; the snapshot is built after.
+void run_depth_publisher() {
+    DepthChanges changes(book.resource());
+    while (true) {
+        std::uint64_t bidRevision = 0;
+        std::uint64_t askRevision = 0;
+        {
+            std::lock_guard<std::mutex> lock(bookMutex);
+            book.drainDepthChanges(changes);
+            bidRevision = book.revision(OrderSide::BUY);
+            askRevision = book.revision(OrderSide::SELL);
+        }
+        depthFeed.publish(changes, bidRevision, askRevision);
+        std::this_thread::sleep_for(DEPTH_SNAPSHOT_INTERVAL);
+    }
+}
+
+int main() {
+    std::cout << "Created Orderbook\n";
+    riskGate.setDefaultLimits(SESSION_RISK_LIMITS);
+    book.enableDepthJournal();
+    std::thread(run_depth_publisher).detach();
+
+    int binary_fd = open_listener(BINARY_PORT);
+    if (binary_fd < 0) {
+        return 1;
+    }
+    std::thread(run_binary_listener, binary_fd).detach();
+    std::cout << "Binary order entry listening on port " << BINARY_PORT << "...\n";
+
+    int server_fd = open_listener(HTTP_PORT);
+    if (server_fd < 0) {
         return 1;
     }
 
-    std::cout << "Server is running on port 8080...\n";
+    std::cout << "Server is running on port " << HTTP_PORT << "...\n";
     while (true) {
-        socklen_t addrlen = sizeof(address);
-        int client_fd = accept(server_fd, (struct sockaddr*)&address, &addrlen);
+        int client_fd = accept(server_fd, nullptr, nullptr);
         if (client_fd < 0) {
             perror("Accept failed");
             continue;
@@ -0,0 +1,98 @@
+#include "BinaryOrderFile.h"
+#include "MappedCSVParse.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+std::uint64_t convertCSVToBinary(const std::string& csvFileName, const std::string& binaryFileName, Price tickSize) {
+    if (tickSize <= 0.0) {
+        throw std::invalid_argument("tick size must be positive");
+    }
+
+    std::ofstream out(binaryFileName, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error(binaryFileName + " :failed to open and does not work");
+    }
+
+    BinaryOrderFileHeader header{};
+    std::memcpy(header.magic, "OBKF", 4);
+    header.version = BINARY_ORDER_FILE_VERSION;
+    header.tickSize = tickSize;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Records are staged in a fixed buffer so the stream sees few large writes.
+    std::vector<BinaryOrderRecord> buffer;
+    buffer.reserve(4096);
+    auto flush = [&]() {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(BinaryOrderRecord));
+        buffer.clear();
+    };
+
+    MappedCSVParse csv(csvFileName);
+    for (const Order& order : csv) {
+        BinaryOrderRecord record{};
+        record.orderId = order.getOrderId();
+        record.quantity = order.getQuantity();
+        record.priceTicks = std::llround(order.getPrice() / tickSize);
+        record.side = static_cast<std::uint8_t>(order.getSide());
+        record.type = static_cast<std::uint8_t>(order.getType());
+        record.duration = static_cast<std::uint8_t>(order.getDuration());
+        buffer.push_back(record);
+        ++header.recordCount;
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+    flush();
+
+    // The count is only known once the CSV has been streamed through.
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+        throw std::runtime_error(binaryFileName + " :failed to write");
+    }
+    return header.recordCount;
+}
+
+// CLASS: BinaryOrderFile
+BinaryOrderFile::BinaryOrderFile(const std::string& fileName)
+    : file_(fileName), header_(nullptr), records_(nullptr), ticksPerUnit_(0.0) {
+    if (file_.size() < sizeof(BinaryOrderFileHeader)) {
+        throw std::runtime_error(fileName + " :too small to be an order file");
+    }
+    header_ = reinterpret_cast<const BinaryOrderFileHeader*>(file_.data());
+    if (std::memcmp(header_->magic, "OBKF", 4) != 0 || header_->version != BINARY_ORDER_FILE_VERSION) {
+        throw std::runtime_error(fileName + " :not a supported order file");
+    }
+    // Divide rather than multiply: a corrupt count could wrap the product.
+    std::size_t capacity = (file_.size() - sizeof(BinaryOrderFileHeader)) / sizeof(BinaryOrderRecord);
+    if (header_->recordCount > capacity) {
+        throw std::runtime_error(fileName + " :truncated order file");
+    }
+    records_ = reinterpret_cast<const BinaryOrderRecord*>(file_.data() + sizeof(BinaryOrderFileHeader));
+
+    // Multiplying by an inexact tick such as 0.01 does not round-trip:
+    // 115 * 0.01 is 1.1500000000000001. Dividing by the exact integer 100
+    // rounds once, to the double nearest 1.15.
+    double perUnit = std::round(1.0 / header_->tickSize);
+    if (perUnit >= 1.0 && std::fabs(perUnit * header_->tickSize - 1.0) < 1e-9) {
+        ticksPerUnit_ = perUnit;
+    }
+}
+
+const BinaryOrderFileHeader& BinaryOrderFile::header() const { return *header_; }
+std::size_t BinaryOrderFile::size() const { return header_->recordCount; }
+Price BinaryOrderFile::tickSize() const { return header_->tickSize; }
+
+const BinaryOrderRecord* BinaryOrderFile::begin() const { return records_; }
+const BinaryOrderRecord* BinaryOrderFile::end() const { return records_ + header_->recordCount; }
+const BinaryOrderRecord& BinaryOrderFile::operator[](std::size_t index) const { return records_[index]; }
+
+Order BinaryOrderFile::toOrder(const BinaryOrderRecord& record) const {
+    Price price = ticksPerUnit_ > 0.0 ? record.priceTicks / ticksPerUnit_ : record.priceTicks * header_->tickSize;
+    return Order(record.orderId, record.quantity, price,
+                 static_cast<OrderType>(record.type),
+                 static_cast<OrderSide>(record.side),
+                 static_cast<DurationType>(record.duration));
+}
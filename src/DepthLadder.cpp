@@ -0,0 +1,195 @@
+#include "DepthLadder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+DepthLadder::DepthLadder(Price tickSize, bool descending)
+    : tickSize_(tickSize), descending_(descending) {
+    if (tickSize <= 0.0) {
+        throw std::invalid_argument("tick size must be positive");
+    }
+}
+
+Price DepthLadder::tickSize() const { return tickSize_; }
+
+bool DepthLadder::complete() const { return outside_.empty(); }
+
+Quantity DepthLadder::totalQuantity() const { return total_; }
+
+Price DepthLadder::bestPrice() const {
+    std::size_t slot = initialized_ ? occupied_.findFirst() : TickBitmap::npos;
+    return slot == TickBitmap::npos ? Price() : tickAt(slot) * tickSize_;
+}
+
+std::int64_t DepthLadder::tickOf(Price price) const {
+    return std::llround(price / tickSize_);
+}
+
+std::int64_t DepthLadder::slotOf(std::int64_t tick) const {
+    return descending_ ? baseTick_ - tick : tick - baseTick_;
+}
+
+std::int64_t DepthLadder::tickAt(std::size_t slot) const {
+    std::int64_t offset = static_cast<std::int64_t>(slot);
+    return descending_ ? baseTick_ - offset : baseTick_ + offset;
+}
+
+void DepthLadder::add(Price price, Quantity delta) {
+    if (delta == 0) {
+        return;
+    }
+    std::int64_t tick = tickOf(price);
+    if (!cover(tick)) {
+        Quantity& outside = outside_[tick];
+        outside += delta;
+        if (outside == 0) {
+            outside_.erase(tick);
+        }
+        return;
+    }
+
+    std::size_t slot = static_cast<std::size_t>(slotOf(tick));
+    bool wasEmpty = quantityAt_[slot] == 0;
+    quantityAt_[slot] += delta;
+    if (quantityAt_[slot] == 0) {
+        occupied_.reset(slot);
+    } else if (wasEmpty) {
+        occupied_.set(slot);
+    }
+    total_ += delta;
+    std::int64_t notional = delta * tick;
+    for (std::size_t i = slot + 1; i < quantityTree_.size(); i += i & (0 - i)) {
+        quantityTree_[i] += delta;
+        notionalTree_[i] += notional;
+    }
+}
+
+// Makes sure `tick` has a slot, doubling the range until it does. False,
+// with nothing changed, if that would take the range past MAX_TICKS.
+bool DepthLadder::cover(std::int64_t tick) {
+    if (!initialized_) {
+        quantityAt_.assign(INITIAL_TICKS, 0);
+        baseTick_ = descending_ ? tick + INITIAL_TICKS / 2 : tick - INITIAL_TICKS / 2;
+        initialized_ = true;
+        rebuild();
+        return true;
+    }
+
+    std::int64_t slot = slotOf(tick);
+    std::int64_t size = static_cast<std::int64_t>(quantityAt_.size());
+    if (slot >= 0 && slot < size) {
+        return true;
+    }
+
+    // Grow towards the side the new tick is on, keeping existing slots.
+    std::int64_t newSize = size;
+    std::int64_t shift = 0;
+    while (slot + shift < 0 || slot + shift >= newSize) {
+        if (newSize * 2 > static_cast<std::int64_t>(MAX_TICKS)) {
+            return false;
+        }
+        if (slot + shift < 0) {
+            shift += newSize;
+        }
+        newSize *= 2;
+    }
+    std::vector<Quantity> moved(static_cast<std::size_t>(newSize), 0);
+    for (std::int64_t i = 0; i < size; ++i) {
+        moved[static_cast<std::size_t>(i + shift)] = quantityAt_[static_cast<std::size_t>(i)];
+    }
+    quantityAt_.swap(moved);
+    baseTick_ = descending_ ? baseTick_ + shift : baseTick_ - shift;
+
+    // Quantity set aside earlier may now have a slot.
+    for (auto it = outside_.begin(); it != outside_.end();) {
+        std::int64_t covered = slotOf(it->first);
+        if (covered >= 0 && covered < newSize) {
+            quantityAt_[static_cast<std::size_t>(covered)] += it->second;
+            total_ += it->second;
+            it = outside_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    rebuild();
+    return true;
+}
+
+// Linear-time Fenwick construction from quantityAt_.
+void DepthLadder::rebuild() {
+    std::size_t n = quantityAt_.size();
+    quantityTree_.assign(n + 1, 0);
+    notionalTree_.assign(n + 1, 0);
+    occupied_.resize(n);
+    for (std::size_t i = 1; i <= n; ++i) {
+        if (quantityAt_[i - 1] != 0) {
+            occupied_.set(i - 1);
+        }
+        quantityTree_[i] += quantityAt_[i - 1];
+        notionalTree_[i] += quantityAt_[i - 1] * tickAt(i - 1);
+        std::size_t parent = i + (i & (0 - i));
+        if (parent <= n) {
+            quantityTree_[parent] += quantityTree_[i];
+            notionalTree_[parent] += notionalTree_[i];
+        }
+    }
+}
+
+Quantity DepthLadder::prefixQuantity(std::size_t slots) const {
+    Quantity sum = 0;
+    for (std::size_t i = slots; i > 0; i -= i & (0 - i)) {
+        sum += quantityTree_[i];
+    }
+    return sum;
+}
+
+Quantity DepthLadder::quantityThrough(Price limit) const {
+    if (!initialized_) {
+        return 0;
+    }
+    std::int64_t slot = slotOf(tickOf(limit));
+    if (slot < 0) {
+        return 0;
+    }
+    if (slot >= static_cast<std::int64_t>(quantityAt_.size())) {
+        return total_;
+    }
+    return prefixQuantity(static_cast<std::size_t>(slot) + 1);
+}
+
+FillEstimate DepthLadder::estimateFill(Quantity requested) const {
+    FillEstimate estimate;
+    estimate.requested = requested;
+    Quantity target = std::min(requested, total_);
+    if (!initialized_ || target <= 0) {
+        return estimate;
+    }
+
+    // Fenwick descent: find the last slot whose prefix stays below target,
+    // collecting the quantity and notional of everything before it.
+    std::size_t n = quantityTree_.size() - 1;
+    std::size_t step = 1;
+    while (step * 2 <= n) {
+        step *= 2;
+    }
+    std::size_t position = 0;
+    Quantity before = 0;
+    std::int64_t notionalBefore = 0;
+    for (; step > 0; step /= 2) {
+        std::size_t next = position + step;
+        if (next <= n && before + quantityTree_[next] < target) {
+            position = next;
+            before += quantityTree_[next];
+            notionalBefore += notionalTree_[next];
+        }
+    }
+
+    // Slot `position` (0-based) is where the cumulative quantity reaches target.
+    std::int64_t worstTick = tickAt(position);
+    estimate.fillable = target;
+    estimate.cost = (static_cast<double>(notionalBefore) + static_cast<double>(target - before) * worstTick) * tickSize_;
+    estimate.averagePrice = estimate.cost / target;
+    estimate.worstPrice = worstTick * tickSize_;
+    return estimate;
+}
@@ -0,0 +1,115 @@
+#include "LatencyProbe.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const std::size_t PROBE_COUNT = static_cast<std::size_t>(ProbePoint::COUNT);
+
+struct ThreadProbes {
+    LogLinearHistogram histograms[PROBE_COUNT];
+};
+
+// Owns every thread's histograms. Entries are never freed, so a reader can
+// still sum a thread's samples after that thread has exited.
+class ProbeRegistry {
+public:
+    static ProbeRegistry& instance() {
+        static ProbeRegistry registry;
+        return registry;
+    }
+
+    ThreadProbes* add() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(std::make_unique<ThreadProbes>());
+        return threads_.back().get();
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor visit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& thread : threads_) {
+            visit(*thread);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadProbes>> threads_;
+};
+
+ThreadProbes& localProbes() {
+    // Registration takes the lock once per thread; every later record is a
+    // plain thread_local access.
+    thread_local ThreadProbes* probes = ProbeRegistry::instance().add();
+    return *probes;
+}
+
+} // namespace
+
+const char* probePointName(ProbePoint point) {
+    switch (point) {
+        case ProbePoint::PARSE: return "parse";
+        case ProbePoint::BOOK_INSERT: return "book_insert";
+        case ProbePoint::MATCH: return "match";
+        case ProbePoint::CANCEL: return "cancel";
+        case ProbePoint::SERIALIZE: return "serialize";
+        case ProbePoint::SEND: return "send";
+        case ProbePoint::COUNT: break;
+    }
+    return "unknown";
+}
+
+void recordProbe(ProbePoint point, std::uint64_t cycles) {
+    localProbes().histograms[static_cast<std::size_t>(point)].record(cycles);
+}
+
+std::string renderProbeMetrics() {
+    std::vector<std::uint64_t> totals(PROBE_COUNT * LogLinearHistogram::BUCKETS, 0);
+    std::vector<std::uint64_t> maxima(PROBE_COUNT, 0);
+    ProbeRegistry::instance().forEach([&](const ThreadProbes& thread) {
+        for (std::size_t p = 0; p < PROBE_COUNT; ++p) {
+            const LogLinearHistogram& histogram = thread.histograms[p];
+            for (std::size_t b = 0; b < LogLinearHistogram::BUCKETS; ++b) {
+                totals[p * LogLinearHistogram::BUCKETS + b] += histogram.count(b);
+            }
+            maxima[p] = std::max(maxima[p], histogram.max());
+        }
+    });
+
+    double perNs = cyclesPerNanosecond();
+    std::ostringstream out;
+#ifndef ORDERBOOK_PROBES
+    out << "# latency probes compiled out; rebuild with -DORDERBOOK_PROBES\n";
+#endif
+    for (std::size_t p = 0; p < PROBE_COUNT; ++p) {
+        const std::uint64_t* buckets = &totals[p * LogLinearHistogram::BUCKETS];
+        std::uint64_t count = 0;
+        for (std::size_t b = 0; b < LogLinearHistogram::BUCKETS; ++b) {
+            count += buckets[b];
+        }
+
+        auto quantile = [&](double q) {
+            if (count == 0) return 0.0;
+            std::uint64_t rank = static_cast<std::uint64_t>(q * (count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t b = 0; b < LogLinearHistogram::BUCKETS; ++b) {
+                seen += buckets[b];
+                if (seen >= rank) return LogLinearHistogram::bucketLowerBound(b) / perNs;
+            }
+            return maxima[p] / perNs;
+        };
+
+        const char* name = probePointName(static_cast<ProbePoint>(p));
+        out << "orderbook_latency_count{probe=\"" << name << "\"} " << count << "\n";
+        out << "orderbook_latency_ns{probe=\"" << name << "\",quantile=\"0.5\"} " << quantile(0.5) << "\n";
+        out << "orderbook_latency_ns{probe=\"" << name << "\",quantile=\"0.99\"} " << quantile(0.99) << "\n";
+        out << "orderbook_latency_ns{probe=\"" << name << "\",quantile=\"0.999\"} " << quantile(0.999) << "\n";
+        out << "orderbook_latency_ns{probe=\"" << name << "\",quantile=\"1\"} " << maxima[p] / perNs << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,158 @@
+#include "MappedCSVParse.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <stdexcept>
+
+namespace {
+
+std::string_view trim(std::string_view field) {
+    size_t first = field.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return std::string_view();
+    size_t last = field.find_last_not_of(" \t\r");
+    return field.substr(first, last - first + 1);
+}
+
+template <typename T>
+bool parseNumber(std::string_view field, T& out) {
+    field = trim(field);
+    const char* last = field.data() + field.size();
+    auto [ptr, ec] = std::from_chars(field.data(), last, out);
+    return ec == std::errc() && ptr == last;
+}
+
+bool isBlank(std::string_view line) {
+    return line.find_first_not_of(" \t\r") == std::string_view::npos;
+}
+
+const char* lineEnd(const char* pos, const char* end) {
+    const void* newline = std::memchr(pos, '\n', end - pos);
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+void throwMalformed() {
+    throw std::invalid_argument("CSV line did not have all required information");
+}
+
+std::vector<Order> parseRange(const char* first, const char* last) {
+    std::vector<Order> orders;
+    orders.reserve((last - first) / 64);
+    while (first < last) {
+        const char* eol = lineEnd(first, last);
+        std::string_view line(first, eol - first);
+        if (!isBlank(line)) {
+            orders.emplace_back();
+            if (!MappedCSVParse::parseLine(line, orders.back())) throwMalformed();
+        }
+        first = eol + 1;
+    }
+    return orders;
+}
+
+} // namespace
+
+bool MappedCSVParse::parseLine(std::string_view line, Order& order) {
+    std::string_view fields[6];
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < 6) {
+        size_t comma = line.find(',', pos);
+        fields[count++] = line.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos);
+        if (comma == std::string_view::npos) break;
+        pos = comma + 1;
+    }
+    if (count < 6) return false;
+
+    OrderID id;
+    Quantity quantity;
+    Price price;
+    if (!parseNumber(fields[0], id) || !parseNumber(fields[1], quantity) || !parseNumber(fields[2], price)) {
+        return false;
+    }
+
+    OrderType type = trim(fields[3]) == "OrderType::MARKET" ? OrderType::MARKET : OrderType::LIMIT;
+    OrderSide side = trim(fields[4]) == "OrderSide::BUY" ? OrderSide::BUY : OrderSide::SELL;
+
+    std::string_view durationName = trim(fields[5]);
+    DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+    if (durationName == "DurationType::IMMEDIATE_OR_CANCEL") duration = DurationType::IMMEDIATE_OR_CANCEL;
+    else if (durationName == "DurationType::FILL_OR_KILL") duration = DurationType::FILL_OR_KILL;
+
+    order = Order(id, quantity, price, type, side, duration);
+    return true;
+}
+
+// CLASS: MappedCSVParse::iterator
+MappedCSVParse::iterator::iterator(const char* pos, const char* end)
+    : next_(pos), end_(end) {
+    advance();
+}
+
+MappedCSVParse::iterator& MappedCSVParse::iterator::operator++() {
+    advance();
+    return *this;
+}
+
+void MappedCSVParse::iterator::advance() {
+    while (next_ != nullptr && next_ < end_) {
+        const char* eol = lineEnd(next_, end_);
+        std::string_view line(next_, eol - next_);
+        pos_ = next_;
+        next_ = eol + 1;
+        if (isBlank(line)) continue;
+        if (!parseLine(line, current_)) throwMalformed();
+        return;
+    }
+    pos_ = nullptr;
+    next_ = nullptr;
+}
+
+// CLASS: MappedCSVParse
+MappedCSVParse::MappedCSVParse(const std::string& fileName)
+    : file_(fileName) {}
+
+MappedCSVParse::iterator MappedCSVParse::begin() const {
+    return iterator(file_.data(), file_.data() + file_.size());
+}
+
+MappedCSVParse::iterator MappedCSVParse::end() const {
+    return iterator();
+}
+
+std::vector<Order> MappedCSVParse::parseOrders() const {
+    return parseRange(file_.data(), file_.data() + file_.size());
+}
+
+void MappedCSVParse::parseOrdersParallel(unsigned numThreads, const ChunkHandler& onChunk, size_t chunkBytes) const {
+    if (numThreads == 0) numThreads = 1;
+    if (chunkBytes == 0) chunkBytes = 1;
+
+    const char* pos = file_.data();
+    const char* end = file_.data() + file_.size();
+    std::deque<std::future<std::vector<Order>>> inFlight;
+
+    auto launchNext = [&]() {
+        if (pos >= end) return;
+        const char* chunkEnd = pos + std::min(chunkBytes, static_cast<size_t>(end - pos));
+        if (chunkEnd < end) {
+            // Extend to the end of the line so no line is split across chunks.
+            chunkEnd = lineEnd(chunkEnd, end);
+            if (chunkEnd < end) ++chunkEnd;
+        }
+        inFlight.push_back(std::async(std::launch::async, parseRange, pos, chunkEnd));
+        pos = chunkEnd;
+    };
+
+    while (inFlight.size() < numThreads && pos < end) {
+        launchNext();
+    }
+    while (!inFlight.empty()) {
+        std::vector<Order> orders = inFlight.front().get();
+        inFlight.pop_front();
+        launchNext();
+        onChunk(orders);
+    }
+}
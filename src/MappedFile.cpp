@@ -0,0 +1,66 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(fileName + " :failed to open and does not work");
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        throw std::runtime_error(fileName + " :failed to stat");
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(fileName + " :failed to mmap");
+        }
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+const char* MappedFile::data() const { return data_; }
+size_t MappedFile::size() const { return size_; }
+std::string_view MappedFile::view() const { return std::string_view(data_, size_); }
@@ -1,56 +1,61 @@
 #include "OrderGenerator.h"
-#include <cstdlib>
 #include <cmath>
 
-OrderGenerator::OrderGenerator(Orderbook& orderbook)
-    : orderbook_(orderbook) {}
+OrderGenerator::OrderGenerator(Orderbook& orderbook, std::uint64_t seed, std::uint64_t stream)
+    : orderbook_(orderbook), rng_(seed, stream) {}
 
 void OrderGenerator::setType(OrderType type) {
     type_ = type;
 }
 
-std::vector<Order> OrderGenerator::generateOrders(int num_orders, OrderID& nextOrderID) {
-    std::vector<Order> orders;
-    Price midPrice = orderbook_.getMidPrice();
-
-    if (midPrice <= 0.0) {
-        midPrice = defaultPrice_;
-    }
+void OrderGenerator::reseed(std::uint64_t seed, std::uint64_t stream) {
+    rng_.reseed(seed, stream);
+}
 
-    for (int i = 0; i < num_orders; ++i) {
-        Quantity qty = std::rand() % 100 + 1;
-        Price price = getRandomPriceAroundMid(midPrice);
-        OrderSide side = (std::rand() % 2 == 0) ? OrderSide::BUY : OrderSide::SELL; // randomly select buy or sell
-        DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+Xoshiro256& OrderGenerator::rng() {
+    return rng_;
+}
 
-        Order order(nextOrderID++, qty, price, type_, side, duration, false);
-        orders.push_back(order);
-    }
+std::vector<Order> OrderGenerator::generateOrders(int num_orders, OrderID& nextOrderID) {
+    std::vector<Order> orders(num_orders);
+    generateInto(orders.data(), orders.size(), nextOrderID);
     return orders;
 }
 
 std::vector<Order> OrderGenerator::generateOrdersFixedRange(int num_orders, OrderID& nextOrderID) {
-    std::vector<Order> orders;
+    std::vector<Order> orders(num_orders);
+    generateIntoFixedRange(orders.data(), orders.size(), nextOrderID);
+    return orders;
+}
+
+void OrderGenerator::generateInto(Order* orders, std::size_t count, OrderID& nextOrderID) {
     Price midPrice = orderbook_.getMidPrice();
 
     if (midPrice <= 0.0) {
         midPrice = defaultPrice_;
     }
 
-    for (int i = 0; i < num_orders; ++i) {
-        Quantity qty = std::rand() % 100 + 1;
-        Price price = std::rand() % 10000;
-        OrderSide side = (std::rand() % 2 == 0) ? OrderSide::BUY : OrderSide::SELL; // randomly select buy or sell
-        DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+    for (std::size_t i = 0; i < count; ++i) {
+        orders[i] = makeOrder(nextOrderID++, getRandomPriceAroundMid(midPrice));
+    }
+}
 
-        Order order(nextOrderID++, qty, price, type_, side, duration, false);
-        orders.push_back(order);
+void OrderGenerator::generateIntoFixedRange(Order* orders, std::size_t count, OrderID& nextOrderID) {
+    for (std::size_t i = 0; i < count; ++i) {
+        orders[i] = makeOrder(nextOrderID++, static_cast<Price>(rng_.uniform(10000)));
     }
-    return orders;
+}
+
+Order OrderGenerator::makeOrder(OrderID id, Price price) {
+    Quantity qty = rng_.uniform(100) + 1;
+    OrderSide side = (rng_.uniform(2) == 0) ? OrderSide::BUY : OrderSide::SELL; // randomly select buy or sell
+    DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+
+    return Order(id, qty, price, type_, side, duration, false);
 }
 
 Price OrderGenerator::getRandomPriceAroundMid(Price midPrice) {
-    double percentageChange = ((std::rand() % 2001) - 1000) / 100000.0; // -1% to +1%
+    double percentageChange = (static_cast<int>(rng_.uniform(2001)) - 1000) / 100000.0; // -1% to +1%
     Price price = midPrice * (1 + percentageChange);
     price = std::round(price * 100.0) / 100.0;
 
@@ -0,0 +1,108 @@
+#include "OrderJson.h"
+
+#include <charconv>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+size_t skipSpace(std::string_view s, size_t pos) {
+    while (pos < s.size() && isSpace(s[pos])) ++pos;
+    return pos;
+}
+
+template <typename T>
+bool parseNumber(std::string_view value, T& out) {
+    const char* first = value.data();
+    const char* last = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(first, last, out);
+    return ec == std::errc() && ptr == last;
+}
+
+} // namespace
+
+bool parseOrderJson(std::string_view json, Order& order) {
+    OrderID orderId = 0;
+    Quantity quantity = 0;
+    Price price = 0.0;
+    OrderSide side = OrderSide::BUY;
+    OrderType type = OrderType::LIMIT;
+    DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+    bool isPersonal = false;
+    bool hasId = false, hasQuantity = false, hasPrice = false;
+
+    size_t pos = skipSpace(json, 0);
+    if (pos == json.size() || json[pos] != '{') return false;
+    ++pos;
+
+    while (true) {
+        pos = skipSpace(json, pos);
+        if (pos == json.size()) return false;
+        if (json[pos] == '}') break;
+        if (json[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        if (json[pos] != '"') return false;
+
+        size_t keyEnd = json.find('"', pos + 1);
+        if (keyEnd == std::string_view::npos) return false;
+        std::string_view key = json.substr(pos + 1, keyEnd - pos - 1);
+
+        pos = skipSpace(json, keyEnd + 1);
+        if (pos == json.size() || json[pos] != ':') return false;
+        pos = skipSpace(json, pos + 1);
+        if (pos == json.size()) return false;
+
+        std::string_view value;
+        if (json[pos] == '"') {
+            size_t valueEnd = json.find('"', pos + 1);
+            if (valueEnd == std::string_view::npos) return false;
+            value = json.substr(pos + 1, valueEnd - pos - 1);
+            pos = valueEnd + 1;
+        } else {
+            size_t valueEnd = pos;
+            while (valueEnd < json.size() && json[valueEnd] != ',' && json[valueEnd] != '}' && !isSpace(json[valueEnd])) {
+                ++valueEnd;
+            }
+            value = json.substr(pos, valueEnd - pos);
+            pos = valueEnd;
+        }
+
+        if (key == "orderId") {
+            if (!parseNumber(value, orderId)) return false;
+            hasId = true;
+        } else if (key == "quantity") {
+            if (!parseNumber(value, quantity)) return false;
+            hasQuantity = true;
+        } else if (key == "price") {
+            if (!parseNumber(value, price)) return false;
+            hasPrice = true;
+        } else if (key == "side") {
+            side = (value == "SELL") ? OrderSide::SELL : OrderSide::BUY;
+        } else if (key == "type") {
+            type = (value == "MARKET") ? OrderType::MARKET : OrderType::LIMIT;
+        } else if (key == "duration") {
+            if (value == "IMMEDIATE_OR_CANCEL") duration = DurationType::IMMEDIATE_OR_CANCEL;
+            else if (value == "FILL_OR_KILL") duration = DurationType::FILL_OR_KILL;
+        } else if (key == "isPersonalOrder") {
+            isPersonal = (value == "true");
+        }
+    }
+
+    if (!hasId || !hasQuantity || !hasPrice || quantity <= 0) return false;
+    order = Order(orderId, quantity, price, type, side, duration, isPersonal);
+    return true;
+}
+
+const char* orderStatusName(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::OPEN: return "OPEN";
+        case OrderStatus::PARTIALLY_FILLED: return "PARTIALLY_FILLED";
+        case OrderStatus::FILLED: return "FILLED";
+        case OrderStatus::CANCELLED: return "CANCELLED";
+    }
+    return "UNKNOWN";
+}
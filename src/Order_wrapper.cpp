@@ -1,34 +1,154 @@
-#include "Order.h"
+#include "OrderbookCApi.h"
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <initializer_list>
+#include <new>
 #include <string>
+#include <vector>
 
-extern "C" {
-    const char* create_order(int orderId, int quantity, double price, const char* type, const char* side) {
-        static std::string result;
+#include "DepthSnapshot.h"
+#include "Order.h"
+#include "Orderbook.h"
 
-        OrderType orderType;
+// The depth arrays are the snapshot's own BookLevel vectors, handed out as
+// ob_level without copying.
+static_assert(sizeof(ob_level) == sizeof(BookLevel) && offsetof(ob_level, price) == offsetof(BookLevel, price) &&
+                  offsetof(ob_level, quantity) == offsetof(BookLevel, quantity),
+              "ob_level must mirror BookLevel");
+static_assert(sizeof(ob_order) == 32 && sizeof(ob_order_result) == 24 && sizeof(ob_trade) == 32,
+              "C ABI structs have fixed sizes");
 
-        if (std::string(type) == "LIMIT") {
-            orderType = OrderType::LIMIT;
-        } else {
-            orderType = OrderType::MARKET;
+struct ob_book {
+    Orderbook book;
+    std::vector<ob_trade> trades;
+    DepthSnapshotPublisher depthFeed;
+    DepthSnapshotPublisher::Snapshot depth;  // pinned for the caller's last ob_get_depth
+};
+
+namespace {
+
+template <typename Enum>
+bool isOneOf(std::uint8_t value, std::initializer_list<Enum> allowed) {
+    for (Enum e : allowed) {
+        if (value == static_cast<std::uint8_t>(e)) {
+            return true;
         }
+    }
+    return false;
+}
+
+// A NaN or infinite price would break the ordering of the level maps, and a
+// live ID would displace the resting order's index entry.
+bool validOrder(const ob_order& order, const Orderbook& book) {
+    return order.quantity > 0 && std::isfinite(order.price) && !book.hasLiveOrder(order.order_id) &&
+           isOneOf(order.side, {OrderSide::BUY, OrderSide::SELL}) &&
+           isOneOf(order.type, {OrderType::LIMIT, OrderType::MARKET}) &&
+           isOneOf(order.duration, {DurationType::GOOD_TILL_CANCELLED, DurationType::IMMEDIATE_OR_CANCEL,
+                                    DurationType::FILL_OR_KILL});
+}
+
+void appendTrades(ob_book& book, const TradeList& trades) {
+    for (const Trade& trade : trades) {
+        book.trades.push_back(ob_trade{trade.getBuyOrder().orderID, trade.getSellOrder().orderID,
+                                       trade.getPrice(), trade.getTradedQuantity()});
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+ob_book* ob_book_create(void) {
+    return new (std::nothrow) ob_book();
+}
 
-        OrderSide orderSide;
+void ob_book_destroy(ob_book* book) {
+    delete book;
+}
 
-        if (std::string(side) == "BUY") {
-            orderSide = OrderSide::BUY;
-        } else {
-            orderSide = OrderSide::SELL;
+size_t ob_submit_orders(ob_book* book, const ob_order* orders, size_t count, ob_order_result* results) {
+    size_t tapeBefore = book->trades.size();
+    for (size_t i = 0; i < count; ++i) {
+        const ob_order& in = orders[i];
+        ob_order_result result{in.order_id, 0, OB_REJECTED, {}};
+        if (validOrder(in, book->book)) {
+            // Exceptions must not cross the C boundary; an order the book
+            // throws on is reported as rejected.
+            try {
+                Order order(in.order_id, in.quantity, in.price, static_cast<OrderType>(in.type),
+                            static_cast<OrderSide>(in.side), static_cast<DurationType>(in.duration),
+                            in.is_personal != 0);
+                appendTrades(*book, book->book.addOrder(order, in.owner));
+                result.filled_quantity = order.getFilledQuantity();
+                result.status = static_cast<std::uint8_t>(order.getStatus());
+            } catch (const std::exception&) {
+                result.status = OB_REJECTED;
+            }
         }
+        if (results) {
+            results[i] = result;
+        }
+    }
+    return book->trades.size() - tapeBefore;
+}
+
+int ob_cancel_order(ob_book* book, uint64_t order_id) {
+    OrderID id = order_id;
+    return book->book.cancelOrder(id) ? 1 : 0;
+}
+
+size_t ob_cancel_owner(ob_book* book, uint32_t owner) {
+    return book->book.cancelOwner(owner);
+}
+
+void ob_get_depth(ob_book* book, ob_depth* out) {
+    book->depthFeed.publish(book->book);
+    book->depth = book->depthFeed.acquire();
+    out->bids = reinterpret_cast<const ob_level*>(book->depth->bids->data());
+    out->bid_count = book->depth->bids->size();
+    out->asks = reinterpret_cast<const ob_level*>(book->depth->asks->data());
+    out->ask_count = book->depth->asks->size();
+}
+
+size_t ob_get_trades(const ob_book* book, const ob_trade** trades) {
+    *trades = book->trades.data();
+    return book->trades.size();
+}
+
+void ob_clear_trades(ob_book* book) {
+    book->trades.clear();
+}
 
-        Order order(orderId, quantity, price, orderType, orderSide, DurationType::GOOD_TILL_CANCELLED);
+const char* create_order(int orderId, int quantity, double price, const char* type, const char* side) {
+    thread_local std::string result;
 
-        result = "Order created: ID =" + std::to_string(order.getOrderId()) +
-                 ", Quantity =" + std::to_string(order.getQuantity()) +
-                 ", Price =" + std::to_string(order.getPrice()) +
-                 ", Type =" + std::string(type) +
-                 ", Side =" + std::string(side);
+    OrderType orderType;
 
-        return result.c_str();
+    if (std::string(type) == "LIMIT") {
+        orderType = OrderType::LIMIT;
+    } else {
+        orderType = OrderType::MARKET;
     }
-}
\ No newline at end of file
+
+    OrderSide orderSide;
+
+    if (std::string(side) == "BUY") {
+        orderSide = OrderSide::BUY;
+    } else {
+        orderSide = OrderSide::SELL;
+    }
+
+    Order order(orderId, quantity, price, orderType, orderSide, DurationType::GOOD_TILL_CANCELLED);
+
+    result = "Order created: ID =" + std::to_string(order.getOrderId()) +
+             ", Quantity =" + std::to_string(order.getQuantity()) +
+             ", Price =" + std::to_string(order.getPrice()) +
+             ", Type =" + std::string(type) +
+             ", Side =" + std::string(side);
+
+    return result.c_str();
+}
+
+}
@@ -1,4 +1,199 @@
 #include "Orderbook.h"
+#include "LatencyProbe.h"
+
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+// glibc malloc on 64-bit: 8 bytes of chunk header, 16-byte granularity,
+// 32-byte minimum chunk.
+std::size_t allocatedBytes(std::size_t requested) {
+    return std::max<std::size_t>(32, (requested + 8 + 15) & ~std::size_t(15));
+}
+
+// Node layouts of the libstdc++ containers the book uses: red-black tree
+// nodes carry a colour and three links, list nodes two links, and hash nodes
+// one link (std::hash<OrderID> is trivial, so no cached hash code).
+const std::size_t MAP_NODE_LINKS = 4 * sizeof(void*);
+const std::size_t LIST_NODE_LINKS = 2 * sizeof(void*);
+const std::size_t HASH_NODE_LINKS = sizeof(void*);
+
+MemoryUsage nodeUsage(std::size_t elements, std::size_t peakElements, std::size_t valueSize, std::size_t linkSize) {
+    MemoryUsage usage;
+    usage.elements = elements;
+    usage.bytesUsed = elements * valueSize;
+    usage.bytesReserved = elements * allocatedBytes(linkSize + valueSize);
+    usage.highWaterBytes = peakElements * allocatedBytes(linkSize + valueSize);
+    return usage;
+}
+
+// First level with live quantity; with lazy cancel, fully dead levels can
+// sit in front of it until they are reclaimed.
+template <typename Levels>
+typename Levels::const_iterator firstLiveLevel(const Levels& levels) {
+    auto it = levels.begin();
+    while (it != levels.end() && it->second.totalQuantity() == 0) {
+        ++it;
+    }
+    return it;
+}
+
+// Volume-maximizing uncross price of a crossed book. Candidates are the
+// level prices inside the crossed range; cumulative demand (bids at or above
+// a price) and supply (asks at or below it) come from one pass each.
+template <typename Bids, typename Asks>
+AuctionResult equilibrium(const Bids& bids, const Asks& asks, Price referencePrice) {
+    AuctionResult result;
+    auto bestBid = firstLiveLevel(bids);
+    auto bestAsk = firstLiveLevel(asks);
+    if (bestBid == bids.end() || bestAsk == asks.end() || bestBid->first < bestAsk->first) {
+        return result;
+    }
+    Price high = bestBid->first;
+    Price low = bestAsk->first;
+
+    // Ascending candidate prices.
+    std::vector<Price> prices;
+    for (auto it = asks.begin(); it != asks.end() && it->first <= high; ++it) {
+        prices.push_back(it->first);
+    }
+    std::size_t askCount = prices.size();
+    for (auto it = bids.begin(); it != bids.end() && it->first >= low; ++it) {
+        prices.push_back(it->first);
+    }
+    std::reverse(prices.begin() + askCount, prices.end());
+    std::inplace_merge(prices.begin(), prices.begin() + askCount, prices.end());
+    prices.erase(std::unique(prices.begin(), prices.end()), prices.end());
+
+    std::vector<Quantity> supply(prices.size());
+    Quantity cumulative = 0;
+    auto askIter = asks.begin();
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        for (; askIter != asks.end() && askIter->first <= prices[i]; ++askIter) {
+            cumulative += askIter->second.totalQuantity();
+        }
+        supply[i] = cumulative;
+    }
+    std::vector<Quantity> demand(prices.size());
+    cumulative = 0;
+    auto bidIter = bids.begin();
+    for (std::size_t i = prices.size(); i-- > 0;) {
+        for (; bidIter != bids.end() && bidIter->first >= prices[i]; ++bidIter) {
+            cumulative += bidIter->second.totalQuantity();
+        }
+        demand[i] = cumulative;
+    }
+
+    // Maximum volume, then minimum absolute imbalance.
+    std::vector<std::size_t> tied;
+    Quantity bestVolume = 0;
+    Quantity bestSurplus = 0;
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        Quantity volume = std::min(demand[i], supply[i]);
+        Quantity surplus = std::abs(demand[i] - supply[i]);
+        if (volume == 0 || volume < bestVolume || (volume == bestVolume && surplus > bestSurplus)) {
+            continue;
+        }
+        if (volume > bestVolume || surplus < bestSurplus) {
+            tied.clear();
+            bestVolume = volume;
+            bestSurplus = surplus;
+        }
+        tied.push_back(i);
+    }
+    if (tied.empty()) {
+        return result;
+    }
+
+    // Market pressure, then the reference price.
+    bool surplusDemand = std::all_of(tied.begin(), tied.end(), [&](std::size_t i) { return demand[i] > supply[i]; });
+    bool surplusSupply = std::all_of(tied.begin(), tied.end(), [&](std::size_t i) { return demand[i] < supply[i]; });
+    std::size_t chosen = tied.front();
+    if (surplusDemand) {
+        chosen = tied.back();
+    } else if (!surplusSupply) {
+        for (std::size_t i : tied) {
+            if (std::abs(prices[i] - referencePrice) < std::abs(prices[chosen] - referencePrice)) {
+                chosen = i;
+            }
+        }
+    }
+
+    result.price = prices[chosen];
+    result.volume = bestVolume;
+    result.imbalance = demand[chosen] - supply[chosen];
+    return result;
+}
+
+// Unindexed depth queries: walk levels from the best price outwards.
+template <typename Levels>
+Quantity depthThrough(const Levels& levels, Price limit) {
+    Quantity sum = 0;
+    for (auto it = levels.begin(); it != levels.end() && !levels.key_comp()(limit, it->first); ++it) {
+        sum += it->second.totalQuantity();
+    }
+    return sum;
+}
+
+template <typename Levels>
+FillEstimate walkFill(const Levels& levels, Quantity requested) {
+    FillEstimate estimate;
+    estimate.requested = requested;
+    for (auto it = levels.begin(); it != levels.end() && estimate.fillable < requested; ++it) {
+        Quantity take = std::min(requested - estimate.fillable, it->second.totalQuantity());
+        if (take == 0) {
+            continue;
+        }
+        estimate.fillable += take;
+        estimate.cost += take * it->first;
+        estimate.worstPrice = it->first;
+    }
+    if (estimate.fillable > 0) {
+        estimate.averagePrice = estimate.cost / estimate.fillable;
+    }
+    return estimate;
+}
+
+// The depth index, if it is enabled and covers every resting price.
+const DepthLadder* usableLadder(const std::optional<DepthLadder>& ladder) {
+    return ladder && ladder->complete() ? &*ladder : nullptr;
+}
+
+// Best level with live quantity. With the depth index, dead levels left in
+// front by lazy cancels are jumped over via its occupancy bitmap instead of
+// being walked; the ladder's tick price is mapped back to the level key.
+template <typename Levels>
+typename Levels::const_iterator bestLiveLevel(const Levels& levels, const std::optional<DepthLadder>& index) {
+    auto it = levels.begin();
+    const DepthLadder* ladder = usableLadder(index);
+    if (ladder == nullptr || it == levels.end() || it->second.totalQuantity() > 0) {
+        return firstLiveLevel(levels);
+    }
+    if (ladder->totalQuantity() == 0) {
+        return levels.end();
+    }
+    Price halfTick = ladder->tickSize() / 2;
+    bool descending = std::is_same<typename Levels::key_compare, std::greater<>>::value;
+    return levels.lower_bound(descending ? ladder->bestPrice() + halfTick : ladder->bestPrice() - halfTick);
+}
+
+// Copies up to TopOfBook::DEPTH live levels, best first, from `from`.
+template <typename Levels>
+std::uint32_t copyTopLevels(const Levels& levels, typename Levels::const_iterator from, BookLevel* out) {
+    std::uint32_t count = 0;
+    for (auto it = from; it != levels.end() && count < TopOfBook::DEPTH; ++it) {
+        if (it->second.totalQuantity() > 0) {
+            out[count++] = BookLevel{it->first, it->second.totalQuantity()};
+        }
+    }
+    return count;
+}
+
+// Queue entries one automatic compaction step may visit.
+const std::size_t COMPACT_STEP = 64;
+
+} // namespace
 
 // CLASS: TradeChild
 TradeChild::TradeChild()
@@ -20,35 +215,84 @@ const Quantity Trade::getTradedQuantity() const {
 
 // CLASS: Orderbook
 
-Order* Orderbook::getOrder(OrderID id) {
+template <typename Traits>
+BasicOrderbook<Traits>::BasicOrderbook(std::pmr::memory_resource* resource)
+    : bids(resource), asks(resource), orders(resource), owners_(resource), dirtyLevels_(resource),
+      pending_(resource), pendingOwners_(resource), pendingIndex_(resource), depthJournal_(resource) {
+    if constexpr (Traits::MAX_ORDERS > 0) {
+        orders.reserve(Traits::MAX_ORDERS);
+    }
+}
+
+template <typename Traits>
+std::pmr::memory_resource* BasicOrderbook<Traits>::resource() const {
+    return orders.get_allocator().resource();
+}
+
+template <typename Traits>
+const Order* BasicOrderbook<Traits>::getOrder(OrderID id) const {
     auto it = orders.find(id);
-    if (it == orders.end()) {
+    if (it == orders.end() || it->second.order.getStatus() == OrderStatus::CANCELLED) {
         return nullptr;
     }
+    return &it->second.order;
+}
 
-    auto [orderIter, priceIter, side] = it->second;
-    return &(*orderIter);
+template <typename Traits>
+bool BasicOrderbook<Traits>::hasLiveOrder(OrderID id) const {
+    return getOrder(id) != nullptr || pendingIndex_.count(id) > 0;
 }
 
-TradeList Orderbook::addOrder(Order& order) {
+template <typename Traits>
+TradeList BasicOrderbook<Traits>::addOrder(Order& order, OwnerID owner) {
+    // Keep dead entries under a quarter of the index, a bounded step at a time.
+    if (tombstones_ > 0 && tombstones_ * 4 > orders.size()) {
+        compact(COMPACT_STEP);
+    }
+
     TradeList trades;
+    // The index holds one entry per ID, so a live ID cannot be reused.
+    if (!Traits::accepts(order) || hasLiveOrder(order.getOrderId())) {
+        order.setStatus(OrderStatus::CANCELLED);
+        return trades;
+    }
+    if (auction_) {
+        // Call phase: nothing matches until the uncross.
+        if (order.getType() == OrderType::MARKET || order.getDuration() != DurationType::GOOD_TILL_CANCELLED) {
+            order.setStatus(OrderStatus::CANCELLED);
+        } else {
+            order.setStatus(OrderStatus::OPEN);
+            if (!restOrder(order, owner)) {
+                order.setStatus(OrderStatus::CANCELLED);
+            }
+        }
+        return trades;
+    }
+    if (batching()) {
+        if (order.getType() == OrderType::MARKET || order.getDuration() == DurationType::FILL_OR_KILL) {
+            order.setStatus(OrderStatus::CANCELLED);
+            return trades;
+        }
+        order.setStatus(OrderStatus::OPEN);
+        pendingIndex_.insert_or_assign(order.getOrderId(), pending_.size());
+        pending_.push_back(order);
+        pendingOwners_.push_back(owner);
+        if (batch_.maxOrders > 0 && pending_.size() >= batch_.maxOrders) {
+            return clearBatch();
+        }
+        return trades;
+    }
+
     Quantity quantityLeft = order.getQuantity();
 
     if (order.getSide() == OrderSide::BUY) {
         // Handle FILL_OR_KILL orders
         if (order.getDuration() == DurationType::FILL_OR_KILL) {
+            // Level totals answer this without visiting individual orders.
             Quantity totalAvailable = 0;
-            auto tempQuantityLeft = quantityLeft;
-            auto askIter = asks.begin();
-            while (tempQuantityLeft > 0 && askIter != asks.end() && 
-                  (order.getType() == OrderType::MARKET || askIter->first <= order.getPrice())) {
-                for (const Order& askOrder : askIter->second) {
-                    totalAvailable += askOrder.getQuantity();
-                    tempQuantityLeft -= askOrder.getQuantity();
-                    if (totalAvailable >= order.getQuantity()) break;
-                }
-                if (totalAvailable >= order.getQuantity()) break;
-                ++askIter;
+            for (auto askIter = asks.begin(); totalAvailable < order.getQuantity() && askIter != asks.end() &&
+                 (order.getType() == OrderType::MARKET || askIter->first <= order.getPrice()); ++askIter) {
+                totalAvailable += askIter->second.totalQuantity();
             }
             if (totalAvailable < order.getQuantity()) {
                 // Cannot fully fill, cancel order
@@ -58,16 +302,35 @@ TradeList Orderbook::addOrder(Order& order) {
         }
 
         // Process asks to match the buy order
+        PROBE_BEGIN(matchStart);
         auto askIter = asks.begin();
         while (quantityLeft > 0 && askIter != asks.end() &&
                (order.getType() == OrderType::MARKET || askIter->first <= order.getPrice())) {
-            std::list<Order>& askOrders = askIter->second;
+            Level& askOrders = askIter->second;
+            if (quantityLeft >= askOrders.totalQuantity()) {
+                // Whole level consumed: fill every order without comparing
+                // quantities or unlinking queue nodes, then release the
+                // level's queue in one go.
+                sweepLevel(order, askIter->first, askOrders, trades);
+                noteDepth(OrderSide::SELL, askIter->first, -askOrders.totalQuantity());
+                quantityLeft -= askOrders.totalQuantity();
+                askIter = asks.erase(askIter);
+                continue;
+            }
+
+            // Only the last level reached is partially consumed.
+            Quantity levelBefore = askOrders.totalQuantity();
             auto orderIter = askOrders.begin();
 
             while (quantityLeft > 0 && orderIter != askOrders.end()) {
-                Order& askOrder = *orderIter;
-                Quantity tradeQuantity = std::min(quantityLeft, askOrder.getQuantity());
-                Price tradePrice = askOrder.getPrice();
+                if (orderIter->isDead()) {
+                    releaseTombstone(*orderIter);
+                    orderIter = askOrders.erase(orderIter);
+                    continue;
+                }
+                Record& askOrder = *orderIter;
+                Quantity tradeQuantity = std::min<Quantity>(quantityLeft, askOrder.quantity);
+                Price tradePrice = askIter->first;
 
                 bool buyIsPersonal = order.getIsPersonalOrder();
                 bool sellIsPersonal = askOrder.getIsPersonalOrder();
@@ -80,15 +343,20 @@ TradeList Orderbook::addOrder(Order& order) {
                 // Update quantities and statuses
                 quantityLeft -= tradeQuantity;
                 order.setFilledQuantity(order.getFilledQuantity() + tradeQuantity);
-                askOrder.setFilledQuantity(askOrder.getFilledQuantity() + tradeQuantity);
 
-                if (tradeQuantity == askOrder.getQuantity()) {
-                    askOrder.setStatus(OrderStatus::FILLED);
-                    orders.erase(askOrder.getOrderId());
+                if (tradeQuantity == askOrder.quantity) {
+                    eraseOrder(askOrder.orderId);
                     orderIter = askOrders.erase(orderIter);
                 } else {
-                    askOrder.setQuantity(askOrder.getQuantity() - tradeQuantity);
-                    askOrder.setStatus(OrderStatus::PARTIALLY_FILLED);
+                    // Only a partial fill reaches into the cold record.
+                    askOrders.adjust(orderIter, -tradeQuantity);
+                    auto resting = orders.find(askOrder.orderId);
+                    if (resting != orders.end()) {
+                        Order& cold = resting->second.order;
+                        cold.setQuantity(askOrder.quantity);
+                        cold.setFilledQuantity(cold.getFilledQuantity() + tradeQuantity);
+                        cold.setStatus(OrderStatus::PARTIALLY_FILLED);
+                    }
                     ++orderIter;
                 }
 
@@ -97,6 +365,7 @@ TradeList Orderbook::addOrder(Order& order) {
                 }
             }
 
+            noteDepth(OrderSide::SELL, askIter->first, askOrders.totalQuantity() - levelBefore);
             if (askOrders.empty()) {
                 askIter = asks.erase(askIter);
             } else {
@@ -107,6 +376,7 @@ TradeList Orderbook::addOrder(Order& order) {
                 break;
             }
         }
+        PROBE_END(matchStart, ProbePoint::MATCH);
 
         // Set order status
         if (order.getFilledQuantity() == order.getQuantity()) {
@@ -134,32 +404,22 @@ TradeList Orderbook::addOrder(Order& order) {
 
         // Add remaining quantity to bids
         if (quantityLeft > 0) {
+            LATENCY_PROBE(ProbePoint::BOOK_INSERT);
             order.setQuantity(quantityLeft);
-            auto [priceIter, inserted] = bids.emplace(order.getPrice(), std::list<Order>());
-            if (!inserted) {
-                priceIter = bids.find(order.getPrice());
-            }
-            priceIter->second.push_back(order);
-            // Store iterators in orders map
-            auto orderIter = std::prev(priceIter->second.end());
-            orders[order.getOrderId()] = OrderInfo{orderIter, priceIter, OrderSide::BUY};
             order.setStatus(order.getFilledQuantity() > 0 ? OrderStatus::PARTIALLY_FILLED : OrderStatus::OPEN);
+            if (!restOrder(order, owner)) {
+                // Over capacity: the remainder is dropped as if IOC.
+                order.setStatus(order.getFilledQuantity() > 0 ? OrderStatus::PARTIALLY_FILLED : OrderStatus::CANCELLED);
+            }
         }
 
     } else if (order.getSide() == OrderSide::SELL) {
         if (order.getDuration() == DurationType::FILL_OR_KILL) {
+            // Level totals answer this without visiting individual orders.
             Quantity totalAvailable = 0;
-            auto tempQuantityLeft = quantityLeft;
-            auto bidIter = bids.begin();
-            while (tempQuantityLeft > 0 && bidIter != bids.end() &&
-                   (order.getType() == OrderType::MARKET || bidIter->first >= order.getPrice())) {
-                for (const Order& bidOrder : bidIter->second) {
-                    totalAvailable += bidOrder.getQuantity();
-                    tempQuantityLeft -= bidOrder.getQuantity();
-                    if (totalAvailable >= order.getQuantity()) break;
-                }
-                if (totalAvailable >= order.getQuantity()) break;
-                ++bidIter;
+            for (auto bidIter = bids.begin(); totalAvailable < order.getQuantity() && bidIter != bids.end() &&
+                 (order.getType() == OrderType::MARKET || bidIter->first >= order.getPrice()); ++bidIter) {
+                totalAvailable += bidIter->second.totalQuantity();
             }
             if (totalAvailable < order.getQuantity()) {
                 // Cannot fully fill, cancel order
@@ -169,16 +429,35 @@ TradeList Orderbook::addOrder(Order& order) {
         }
 
         // Process bids to match the sell order
+        PROBE_BEGIN(matchStart);
         auto bidIter = bids.begin();
         while (quantityLeft > 0 && bidIter != bids.end() &&
                (order.getType() == OrderType::MARKET || bidIter->first >= order.getPrice())) {
-            std::list<Order>& bidOrders = bidIter->second;
+            Level& bidOrders = bidIter->second;
+            if (quantityLeft >= bidOrders.totalQuantity()) {
+                // Whole level consumed: fill every order without comparing
+                // quantities or unlinking queue nodes, then release the
+                // level's queue in one go.
+                sweepLevel(order, bidIter->first, bidOrders, trades);
+                noteDepth(OrderSide::BUY, bidIter->first, -bidOrders.totalQuantity());
+                quantityLeft -= bidOrders.totalQuantity();
+                bidIter = bids.erase(bidIter);
+                continue;
+            }
+
+            // Only the last level reached is partially consumed.
+            Quantity levelBefore = bidOrders.totalQuantity();
             auto orderIter = bidOrders.begin();
 
             while (quantityLeft > 0 && orderIter != bidOrders.end()) {
-                Order& bidOrder = *orderIter;
-                Quantity tradeQuantity = std::min(quantityLeft, bidOrder.getQuantity());
-                Price tradePrice = bidOrder.getPrice();
+                if (orderIter->isDead()) {
+                    releaseTombstone(*orderIter);
+                    orderIter = bidOrders.erase(orderIter);
+                    continue;
+                }
+                Record& bidOrder = *orderIter;
+                Quantity tradeQuantity = std::min<Quantity>(quantityLeft, bidOrder.quantity);
+                Price tradePrice = bidIter->first;
 
                 bool buyIsPersonal = bidOrder.getIsPersonalOrder();
                 bool sellIsPersonal = order.getIsPersonalOrder();
@@ -191,15 +470,20 @@ TradeList Orderbook::addOrder(Order& order) {
                 // Update quantities and statuses
                 quantityLeft -= tradeQuantity;
                 order.setFilledQuantity(order.getFilledQuantity() + tradeQuantity);
-                bidOrder.setFilledQuantity(bidOrder.getFilledQuantity() + tradeQuantity);
 
-                if (tradeQuantity == bidOrder.getQuantity()) {
-                    bidOrder.setStatus(OrderStatus::FILLED);
-                    orders.erase(bidOrder.getOrderId());
+                if (tradeQuantity == bidOrder.quantity) {
+                    eraseOrder(bidOrder.orderId);
                     orderIter = bidOrders.erase(orderIter);
                 } else {
-                    bidOrder.setQuantity(bidOrder.getQuantity() - tradeQuantity);
-                    bidOrder.setStatus(OrderStatus::PARTIALLY_FILLED);
+                    // Only a partial fill reaches into the cold record.
+                    bidOrders.adjust(orderIter, -tradeQuantity);
+                    auto resting = orders.find(bidOrder.orderId);
+                    if (resting != orders.end()) {
+                        Order& cold = resting->second.order;
+                        cold.setQuantity(bidOrder.quantity);
+                        cold.setFilledQuantity(cold.getFilledQuantity() + tradeQuantity);
+                        cold.setStatus(OrderStatus::PARTIALLY_FILLED);
+                    }
                     ++orderIter;
                 }
 
@@ -208,6 +492,7 @@ TradeList Orderbook::addOrder(Order& order) {
                 }
             }
 
+            noteDepth(OrderSide::BUY, bidIter->first, bidOrders.totalQuantity() - levelBefore);
             if (bidOrders.empty()) {
                 bidIter = bids.erase(bidIter);
             } else {
@@ -218,6 +503,7 @@ TradeList Orderbook::addOrder(Order& order) {
                 break;
             }
         }
+        PROBE_END(matchStart, ProbePoint::MATCH);
 
         // Set order status
         if (order.getFilledQuantity() == order.getQuantity()) {
@@ -245,56 +531,182 @@ TradeList Orderbook::addOrder(Order& order) {
 
         // Add remaining quantity to asks
         if (quantityLeft > 0) {
+            LATENCY_PROBE(ProbePoint::BOOK_INSERT);
             order.setQuantity(quantityLeft);
-            auto [priceIter, inserted] = asks.emplace(order.getPrice(), std::list<Order>());
-            if (!inserted) {
-                priceIter = asks.find(order.getPrice());
-            }
-            priceIter->second.push_back(order);
-            // Store iterators in orders map
-            auto orderIter = std::prev(priceIter->second.end());
-            orders[order.getOrderId()] = OrderInfo{orderIter, priceIter, OrderSide::SELL};
             order.setStatus(order.getFilledQuantity() > 0 ? OrderStatus::PARTIALLY_FILLED : OrderStatus::OPEN);
+            if (!restOrder(order, owner)) {
+                // Over capacity: the remainder is dropped as if IOC.
+                order.setStatus(order.getFilledQuantity() > 0 ? OrderStatus::PARTIALLY_FILLED : OrderStatus::CANCELLED);
+            }
         }
     }
 
     return trades;
 }
 
+// Puts the order's remaining quantity at the back of its price level. False,
+// leaving the book untouched, if that would exceed the book's capacity or an
+// order with the same ID is still resting.
+template <typename Traits>
+bool BasicOrderbook<Traits>::restOrder(const Order& order, OwnerID owner) {
+    OrderSide side = order.getSide();
+    if (!hasCapacity(side, order.getPrice()) || getOrder(order.getOrderId()) != nullptr) {
+        return false;
+    }
+    // try_emplace builds a new level's queue on the book's resource
+    PriceKey key(order.getPrice());
+    auto priceIter = side == OrderSide::BUY ? bids.try_emplace(key).first : asks.try_emplace(key).first;
+    using QuantityRep = typename Traits::QuantityRep;
+    using OrderIdRep = typename Traits::OrderIdRep;
+    auto orderIter = priceIter->second.append(Record{static_cast<OrderIdRep>(order.getOrderId()),
+                                                     static_cast<QuantityRep>(order.getQuantity()),
+                                                     order.getIsPersonalOrder()});
+    // Store the cold copy and iterators in orders map. A reused ID's old
+    // entry leaves its owner list before being overwritten.
+    if (!owners_.empty()) {
+        auto previous = orders.find(order.getOrderId());
+        if (previous != orders.end()) {
+            unlinkOwner(previous->second);
+        }
+    }
+    auto stored = orders.insert_or_assign(order.getOrderId(), OrderInfo{order, orderIter, priceIter, side, owner});
+    if (owner != NO_OWNER) {
+        linkOwner(stored.first->second);
+    }
+    noteDepth(side, priceIter->first, order.getQuantity());
+    noteFootprint();
+    return true;
+}
+
+// Compiles to `return true` for an unbounded book.
+template <typename Traits>
+bool BasicOrderbook<Traits>::hasCapacity(OrderSide side, Price price) const {
+    if constexpr (Traits::MAX_ORDERS > 0) {
+        if (orders.size() >= Traits::MAX_ORDERS) {
+            return false;
+        }
+    }
+    if constexpr (Traits::MAX_LEVELS > 0) {
+        bool full = side == OrderSide::BUY ? bids.size() >= Traits::MAX_LEVELS : asks.size() >= Traits::MAX_LEVELS;
+        if (full) {
+            return side == OrderSide::BUY ? bids.find(price) != bids.end() : asks.find(price) != asks.end();
+        }
+    }
+    return true;
+}
+
+// Fills `order` against every resting order at one level, which it is known
+// to consume entirely. The caller erases the level afterwards, which frees
+// the whole queue at once. Index entries are not freed in bulk: each order
+// still costs one trade and one index erase with its owner unlink, so a
+// sweep is linear in the level's orders and saves only the queue work.
+template <typename Traits>
+void BasicOrderbook<Traits>::sweepLevel(Order& order, Price price, const Level& level, TradeList& trades) {
+    bool isBuy = order.getSide() == OrderSide::BUY;
+    std::size_t needed = trades.size() + level.size();
+    if (trades.capacity() < needed) {
+        trades.reserve(std::max(needed, 2 * trades.capacity()));
+    }
+
+    TradeChild taker(order.getOrderId(), price, 0, order.getIsPersonalOrder());
+    for (const Record& resting : level) {
+        if (resting.isDead()) {
+            releaseTombstone(resting);
+            continue;
+        }
+        TradeChild maker(resting.orderId, price, resting.quantity, resting.isPersonalOrder);
+        taker.quantity = resting.quantity;
+        if (isBuy) {
+            trades.emplace_back(taker, maker, price);
+        } else {
+            trades.emplace_back(maker, taker, price);
+        }
+        eraseOrder(resting.orderId);
+    }
+    order.setFilledQuantity(order.getFilledQuantity() + level.totalQuantity());
+}
+
+// Drops the index entry of a dead order whose queue entry is going away. The
+// ID may since have been reused by a new order, whose entry must survive.
+template <typename Traits>
+void BasicOrderbook<Traits>::releaseTombstone(const Record& record) {
+    auto it = orders.find(record.orderId);
+    if (it != orders.end() && &*it->second.orderIterator == &record) {
+        orders.erase(it);
+    }
+    --tombstones_;
+}
+
 // Helper function to rollback trades
-void Orderbook::rollbackTrades(const TradeList& trades) {
+template <typename Traits>
+void BasicOrderbook<Traits>::rollbackTrades(const TradeList& trades) {
     for (const auto& trade : trades) {
         // Rollback for buy order
         OrderID buyOrderID = trade.getBuyOrder().orderID;
         auto buyIt = orders.find(buyOrderID);
         if (buyIt != orders.end()) {
-            Order& buyOrder = *(buyIt->second.orderIterator);
+            Order& buyOrder = buyIt->second.order;
             Quantity tradeQty = trade.getTradedQuantity();
             buyOrder.setFilledQuantity(buyOrder.getFilledQuantity() - tradeQty);
             buyOrder.setQuantity(buyOrder.getQuantity() + tradeQty);
             buyOrder.setStatus(OrderStatus::OPEN);
+            buyIt->second.priceIterator->second.adjust(buyIt->second.orderIterator, tradeQty);
+            noteDepth(buyIt->second.side, buyIt->second.priceIterator->first, tradeQty);
         }
 
         // Rollback for sell order
         OrderID sellOrderID = trade.getSellOrder().orderID;
         auto sellIt = orders.find(sellOrderID);
         if (sellIt != orders.end()) {
-            Order& sellOrder = *(sellIt->second.orderIterator);
+            Order& sellOrder = sellIt->second.order;
             Quantity tradeQty = trade.getTradedQuantity();
             sellOrder.setFilledQuantity(sellOrder.getFilledQuantity() - tradeQty);
             sellOrder.setQuantity(sellOrder.getQuantity() + tradeQty);
             sellOrder.setStatus(OrderStatus::OPEN);
+            sellIt->second.priceIterator->second.adjust(sellIt->second.orderIterator, tradeQty);
+            noteDepth(sellIt->second.side, sellIt->second.priceIterator->first, tradeQty);
         }
     }
 }
 
-bool Orderbook::cancelOrder(OrderID& orderID) {
+template <typename Traits>
+bool BasicOrderbook<Traits>::cancelOrder(OrderID& orderID) {
+    LATENCY_PROBE(ProbePoint::CANCEL);
     auto it = orders.find(orderID);
-    if (it == orders.end()) {
+    if (it == orders.end() && !pendingIndex_.empty()) {
+        // Still waiting in the open batch: skipped when the batch clears.
+        auto queued = pendingIndex_.find(orderID);
+        if (queued == pendingIndex_.end()) {
+            return false;
+        }
+        pending_[queued->second].setStatus(OrderStatus::CANCELLED);
+        pendingIndex_.erase(queued);
+        return true;
+    }
+    if (it == orders.end() || it->second.order.getStatus() == OrderStatus::CANCELLED) {
         return false;
     }
+    return cancelResting(it);
+}
+
+// Cancels one live resting order.
+template <typename Traits>
+bool BasicOrderbook<Traits>::cancelResting(typename OrderIndex::iterator it) {
+    OrderInfo& info = it->second;
+    auto orderIter = info.orderIterator;
+    auto priceIter = info.priceIterator;
+    OrderSide side = info.side;
+    noteDepth(side, priceIter->first, -orderIter->quantity);
+    unlinkOwner(info);
+    if (lazyCancel_) {
+        info.order.setStatus(OrderStatus::CANCELLED);
+        if (priceIter->second.kill(orderIter)) {
+            dirtyLevels_.emplace_back(side, priceIter->first);
+        }
+        ++tombstones_;
+        return true;
+    }
 
-    auto [orderIter, priceIter, side] = it->second;
     priceIter->second.erase(orderIter);
 
     if (priceIter->second.empty()) {
@@ -309,49 +721,593 @@ bool Orderbook::cancelOrder(OrderID& orderID) {
     return true;
 }
 
-const std::map<Price, std::list<Order>, std::greater<>>& Orderbook::getBids() const { 
+template <typename Traits>
+bool BasicOrderbook<Traits>::reduceOrder(OrderID id, Quantity newQuantity) {
+    auto it = orders.find(id);
+    if (it == orders.end() || it->second.order.getStatus() == OrderStatus::CANCELLED ||
+        newQuantity <= 0 || newQuantity > it->second.order.getQuantity()) {
+        return false;
+    }
+    OrderInfo& info = it->second;
+    Quantity delta = newQuantity - info.order.getQuantity();
+    info.priceIterator->second.adjust(info.orderIterator, delta);
+    noteDepth(info.side, info.priceIterator->first, delta);
+    info.order.setQuantity(newQuantity);
+    return true;
+}
+
+template <typename Traits>
+TradeList BasicOrderbook<Traits>::amendOrder(OrderID id, Quantity quantity, Price price) {
+    const Order* resting = getOrder(id);
+    if (resting == nullptr || quantity <= 0) {
+        return TradeList();
+    }
+    if (price == resting->getPrice() && reduceOrder(id, quantity)) {
+        return TradeList();
+    }
+    Order replacement(id, quantity, price, resting->getType(), resting->getSide(), resting->getDuration(),
+                      resting->getIsPersonalOrder());
+    OwnerID owner = orders.find(id)->second.owner;
+    cancelOrder(id);
+    return addOrder(replacement, owner);
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::setLazyCancel(bool enabled) {
+    lazyCancel_ = enabled;
+}
+
+template <typename Traits>
+bool BasicOrderbook<Traits>::lazyCancel() const {
+    return lazyCancel_;
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::tombstoneCount() const {
+    return tombstones_;
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::compact(std::size_t budget) {
+    std::size_t visited = 0;
+    std::size_t reclaimed = 0;
+    while (visited < budget && !dirtyLevels_.empty()) {
+        auto [side, price] = dirtyLevels_.back();
+        bool finished = side == OrderSide::BUY ? compactLevel(bids, price, budget, visited, reclaimed)
+                                               : compactLevel(asks, price, budget, visited, reclaimed);
+        if (finished) {
+            dirtyLevels_.pop_back();
+        }
+    }
+    return reclaimed;
+}
+
+// Removes dead orders from one level. Returns false if the budget ran out
+// first; the next call resumes where this one stopped, and a pass wraps to
+// the front for orders killed behind it, so every call makes progress.
+template <typename Traits>
+template <typename Levels>
+bool BasicOrderbook<Traits>::compactLevel(Levels& levels, Price price, std::size_t budget, std::size_t& visited, std::size_t& reclaimed) {
+    auto levelIter = levels.find(price);
+    if (levelIter == levels.end()) {
+        return true;
+    }
+    Level& level = levelIter->second;
+    auto it = level.resumePoint();
+    while (level.deadCount() > 0) {
+        if (it == level.end()) {
+            it = level.begin();
+        }
+        if (visited++ >= budget) {
+            level.setResumePoint(it);
+            return false;
+        }
+        if (it->isDead()) {
+            releaseTombstone(*it);
+            it = level.erase(it);
+            ++reclaimed;
+        } else {
+            ++it;
+        }
+    }
+    level.setResumePoint(level.end());
+    if (level.empty()) {
+        levels.erase(levelIter);
+    }
+    return true;
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::cancelOwner(OwnerID owner) {
+    return cancelOwnerSide(owner, OrderSide::BUY) + cancelOwnerSide(owner, OrderSide::SELL);
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::cancelOwner(OwnerID owner, OrderSide side) {
+    return cancelOwnerSide(owner, side);
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::cancelOwnerSide(OwnerID owner, OrderSide side) {
+    auto found = owners_.find(owner);
+    if (owner == NO_OWNER || found == owners_.end()) {
+        return 0;
+    }
+    // Each cancel unlinks the order (and may drop the owner's entry), so
+    // step along saved links rather than the live list.
+    std::size_t cancelled = 0;
+    OrderInfo* info = found->second.head[side == OrderSide::BUY ? 0 : 1];
+    while (info != nullptr) {
+        OrderInfo* next = info->ownerNext;
+        cancelResting(orders.find(info->order.getOrderId()));
+        ++cancelled;
+        info = next;
+    }
+    return cancelled;
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::cancelLevel(OrderSide side, Price price) {
+    return side == OrderSide::BUY ? cancelLevelIn(bids, side, price) : cancelLevelIn(asks, side, price);
+}
+
+// Drops a whole level, live and dead orders alike; any dirtyLevels_ entry
+// for it goes stale and is skipped by compact().
+template <typename Traits>
+template <typename Levels>
+std::size_t BasicOrderbook<Traits>::cancelLevelIn(Levels& levels, OrderSide side, Price price) {
+    auto levelIter = levels.find(price);
+    if (levelIter == levels.end()) {
+        return 0;
+    }
+    Level& level = levelIter->second;
+    std::size_t cancelled = 0;
+    for (const Record& record : level) {
+        if (record.isDead()) {
+            releaseTombstone(record);
+            continue;
+        }
+        eraseOrder(record.orderId);
+        ++cancelled;
+    }
+    noteDepth(side, levelIter->first, -level.totalQuantity());
+    levels.erase(levelIter);
+    return cancelled;
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::ownerOrderCount(OwnerID owner) const {
+    auto found = owners_.find(owner);
+    if (owner == NO_OWNER || found == owners_.end()) {
+        return 0;
+    }
+    std::size_t count = 0;
+    for (const OrderInfo* head : found->second.head) {
+        for (const OrderInfo* info = head; info != nullptr; info = info->ownerNext) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+template <typename Traits>
+OwnerID BasicOrderbook<Traits>::getOwner(OrderID id) const {
+    auto it = orders.find(id);
+    if (it == orders.end() || it->second.order.getStatus() == OrderStatus::CANCELLED) {
+        return NO_OWNER;
+    }
+    return it->second.owner;
+}
+
+// Removes a live order's index entry, and with it its owner link. No-op for
+// an ID the index does not hold.
+template <typename Traits>
+void BasicOrderbook<Traits>::eraseOrder(OrderID id) {
+    auto it = orders.find(id);
+    if (it == orders.end()) {
+        return;
+    }
+    unlinkOwner(it->second);
+    orders.erase(it);
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::linkOwner(OrderInfo& info) {
+    OrderInfo*& head = owners_[info.owner].head[info.side == OrderSide::BUY ? 0 : 1];
+    info.ownerPrev = nullptr;
+    info.ownerNext = head;
+    if (head != nullptr) {
+        head->ownerPrev = &info;
+    }
+    head = &info;
+}
+
+// No-op for an order without an owner or already unlinked.
+template <typename Traits>
+void BasicOrderbook<Traits>::unlinkOwner(OrderInfo& info) {
+    if (info.owner == NO_OWNER) {
+        return;
+    }
+    if (info.ownerNext != nullptr) {
+        info.ownerNext->ownerPrev = info.ownerPrev;
+    }
+    if (info.ownerPrev != nullptr) {
+        info.ownerPrev->ownerNext = info.ownerNext;
+    } else {
+        auto found = owners_.find(info.owner);
+        OwnerOrders& lists = found->second;
+        lists.head[info.side == OrderSide::BUY ? 0 : 1] = info.ownerNext;
+        if (lists.head[0] == nullptr && lists.head[1] == nullptr) {
+            owners_.erase(found);
+        }
+    }
+    info.owner = NO_OWNER;
+    info.ownerPrev = nullptr;
+    info.ownerNext = nullptr;
+}
+
+template <typename Traits>
+const typename BasicOrderbook<Traits>::Bids& BasicOrderbook<Traits>::getBids() const { 
     return bids; 
 }
 
-const std::map<Price, std::list<Order>, std::less<>>& Orderbook::getAsks() const { 
+template <typename Traits>
+const typename BasicOrderbook<Traits>::Asks& BasicOrderbook<Traits>::getAsks() const { 
     return asks; 
 }
 
-const Price Orderbook::getHighestBid() const {
-    return bids.empty() ? Price() : bids.begin()->first;
+template <typename Traits>
+const Price BasicOrderbook<Traits>::getHighestBid() const {
+    auto best = bestLiveLevel(bids, bidDepth_);
+    return best == bids.end() ? Price() : best->first;
 }
 
-const Price Orderbook::getLowestAsk() const {
-    return asks.empty() ? Price() : asks.begin()->first;
+template <typename Traits>
+const Price BasicOrderbook<Traits>::getLowestAsk() const {
+    auto best = bestLiveLevel(asks, askDepth_);
+    return best == asks.end() ? Price() : best->first;
 }
 
-const Price Orderbook::getMidPrice() const {
-    if (bids.empty() || asks.empty()) {
+template <typename Traits>
+const Price BasicOrderbook<Traits>::getMidPrice() const {
+    auto bestBid = bestLiveLevel(bids, bidDepth_);
+    auto bestAsk = bestLiveLevel(asks, askDepth_);
+    if (bestBid == bids.end() || bestAsk == asks.end()) {
         return Price();
     }
-    return (getHighestBid() + getLowestAsk()) / 2;
+    return (bestBid->first + bestAsk->first) / 2;
+}
+
+template <typename Traits>
+TopOfBook BasicOrderbook<Traits>::topOfBook() const {
+    TopOfBook top;
+    top.bidCount = copyTopLevels(bids, bestLiveLevel(bids, bidDepth_), top.bids);
+    top.askCount = copyTopLevels(asks, bestLiveLevel(asks, askDepth_), top.asks);
+    return top;
 }
 
-const Quantity Orderbook::getBidInterest() const {
+template <typename Traits>
+const Quantity BasicOrderbook<Traits>::getBidInterest() const {
     Quantity sum = 0;
     for (const auto& bidPair : bids) {
-        for (const Order& bidOrder : bidPair.second) {
-            sum += bidOrder.getQuantity();
-        }
+        sum += bidPair.second.totalQuantity();
     }
     return sum;
 }
 
-const Quantity Orderbook::getSellInterest() const {
+template <typename Traits>
+const Quantity BasicOrderbook<Traits>::getSellInterest() const {
     Quantity sum = 0;
     for (const auto& askPair : asks) {
-        for (const Order& askOrder : askPair.second) {
-            sum += askOrder.getQuantity();
-        }
+        sum += askPair.second.totalQuantity();
     }
     return sum;
 }
 
-const Quantity Orderbook::getNetInterest() const {
+template <typename Traits>
+const Quantity BasicOrderbook<Traits>::getNetInterest() const {
     return getBidInterest() - getSellInterest();
-}
\ No newline at end of file
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::beginAuction() {
+    auction_ = true;
+}
+
+template <typename Traits>
+bool BasicOrderbook<Traits>::inAuction() const {
+    return auction_;
+}
+
+template <typename Traits>
+AuctionResult BasicOrderbook<Traits>::indicativeUncross(Price referencePrice) const {
+    return equilibrium(bids, asks, referencePrice);
+}
+
+template <typename Traits>
+AuctionResult BasicOrderbook<Traits>::uncross(Price referencePrice) {
+    auction_ = false;
+    return executeUncross(referencePrice);
+}
+
+template <typename Traits>
+AuctionResult BasicOrderbook<Traits>::executeUncross(Price referencePrice) {
+    AuctionResult result = equilibrium(bids, asks, referencePrice);
+    result.trades.reserve(std::min<std::size_t>(orders.size(), result.volume));
+
+    // Both sides are consumed from their best price inwards; the volume never
+    // exceeds what rests at or through the uncross price on either side.
+    Quantity remaining = result.volume;
+    while (remaining > 0) {
+        Level& bidLevel = bids.begin()->second;
+        Level& askLevel = asks.begin()->second;
+        // Tombstones left by lazy cancels go as they reach the front.
+        while (!bidLevel.empty() && bidLevel.front().isDead()) {
+            releaseTombstone(bidLevel.front());
+            bidLevel.erase(bidLevel.begin());
+        }
+        while (!askLevel.empty() && askLevel.front().isDead()) {
+            releaseTombstone(askLevel.front());
+            askLevel.erase(askLevel.begin());
+        }
+        if (!bidLevel.empty() && !askLevel.empty()) {
+            const Record& buy = bidLevel.front();
+            const Record& sell = askLevel.front();
+            Quantity quantity = std::min<Quantity>({remaining, buy.quantity, sell.quantity});
+            result.trades.emplace_back(TradeChild(buy.orderId, result.price, quantity, buy.isPersonalOrder),
+                                       TradeChild(sell.orderId, result.price, quantity, sell.isPersonalOrder),
+                                       result.price);
+            fillResting(bidLevel, OrderSide::BUY, bids.begin()->first, quantity);
+            fillResting(askLevel, OrderSide::SELL, asks.begin()->first, quantity);
+            remaining -= quantity;
+        }
+        if (bidLevel.empty()) {
+            bids.erase(bids.begin());
+        }
+        if (askLevel.empty()) {
+            asks.erase(asks.begin());
+        }
+    }
+    return result;
+}
+
+template <typename Traits>
+TradeList BasicOrderbook<Traits>::setBatchMode(const BatchConfig& config) {
+    TradeList trades = clearBatch();
+    batch_ = config;
+    batchDeadline_ = 0;
+    pendingIndex_.reserve(config.maxOrders);
+    return trades;
+}
+
+template <typename Traits>
+bool BasicOrderbook<Traits>::batching() const {
+    return batch_.maxOrders > 0 || batch_.interval > 0;
+}
+
+template <typename Traits>
+TradeList BasicOrderbook<Traits>::advanceClock(Timestamp now) {
+    if (batch_.interval == 0) {
+        return TradeList();
+    }
+    if (batchDeadline_ == 0) {
+        batchDeadline_ = (now / batch_.interval + 1) * batch_.interval;
+        return TradeList();
+    }
+    if (now < batchDeadline_) {
+        return TradeList();
+    }
+    batchDeadline_ = (now / batch_.interval + 1) * batch_.interval;
+    return clearBatch();
+}
+
+template <typename Traits>
+TradeList BasicOrderbook<Traits>::clearBatch() {
+    if (pendingIndex_.empty()) {
+        pending_.clear();
+        pendingOwners_.clear();
+        return TradeList();
+    }
+    auto bestBid = firstLiveLevel(bids);
+    auto bestAsk = firstLiveLevel(asks);
+    Price reference = bestBid != bids.end() && bestAsk != asks.end() ? (bestBid->first + bestAsk->first) / 2
+                                                                     : lastClearingPrice_;
+
+    // Rested in arrival order, which is time priority within each level. An
+    // order the book has no room for is dropped.
+    pendingIndex_.clear();
+    for (std::size_t i = 0; i < pending_.size(); ++i) {
+        Order& order = pending_[i];
+        if (order.getStatus() != OrderStatus::CANCELLED && !restOrder(order, pendingOwners_[i])) {
+            order.setStatus(OrderStatus::CANCELLED);
+            if (batchDropHandler_) {
+                batchDropHandler_(order.getOrderId());
+            }
+        }
+    }
+
+    AuctionResult result = executeUncross(reference);
+    if (result.volume > 0) {
+        lastClearingPrice_ = result.price;
+    }
+    for (const Order& order : pending_) {
+        if (order.getDuration() == DurationType::IMMEDIATE_OR_CANCEL && order.getStatus() != OrderStatus::CANCELLED) {
+            OrderID id = order.getOrderId();
+            if (cancelOrder(id) && batchDropHandler_) {
+                batchDropHandler_(id);
+            }
+        }
+    }
+    pending_.clear();
+    pendingOwners_.clear();
+    return std::move(result.trades);
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::setBatchDropHandler(std::function<void(OrderID)> handler) {
+    batchDropHandler_ = std::move(handler);
+}
+
+template <typename Traits>
+std::size_t BasicOrderbook<Traits>::pendingBatchSize() const {
+    return pendingIndex_.size();
+}
+
+// Takes `quantity` off the order at the front of a level, which is live.
+template <typename Traits>
+void BasicOrderbook<Traits>::fillResting(Level& level, OrderSide side, Price price, Quantity quantity) {
+    auto front = level.begin();
+    noteDepth(side, price, -quantity);
+    if (quantity == front->quantity) {
+        eraseOrder(front->orderId);
+        level.erase(front);
+        return;
+    }
+    level.adjust(front, -quantity);
+    auto resting = orders.find(front->orderId);
+    if (resting == orders.end()) {
+        return;
+    }
+    Order& cold = resting->second.order;
+    cold.setQuantity(front->quantity);
+    cold.setFilledQuantity(cold.getFilledQuantity() + quantity);
+    cold.setStatus(OrderStatus::PARTIALLY_FILLED);
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::enableDepthIndex(Price tickSize) {
+    bidDepth_.emplace(tickSize, true);
+    askDepth_.emplace(tickSize, false);
+    for (const auto& [price, level] : bids) {
+        bidDepth_->add(price, level.totalQuantity());
+    }
+    for (const auto& [price, level] : asks) {
+        askDepth_->add(price, level.totalQuantity());
+    }
+}
+
+template <typename Traits>
+bool BasicOrderbook<Traits>::depthIndexed() const {
+    return askDepth_.has_value();
+}
+
+template <typename Traits>
+Quantity BasicOrderbook<Traits>::askDepthThrough(Price limit) const {
+    if (const DepthLadder* ladder = usableLadder(askDepth_)) {
+        return ladder->quantityThrough(limit);
+    }
+    return depthThrough(asks, limit);
+}
+
+template <typename Traits>
+Quantity BasicOrderbook<Traits>::bidDepthThrough(Price limit) const {
+    if (const DepthLadder* ladder = usableLadder(bidDepth_)) {
+        return ladder->quantityThrough(limit);
+    }
+    return depthThrough(bids, limit);
+}
+
+template <typename Traits>
+FillEstimate BasicOrderbook<Traits>::estimateBuy(Quantity quantity) const {
+    if (const DepthLadder* ladder = usableLadder(askDepth_)) {
+        return ladder->estimateFill(quantity);
+    }
+    return walkFill(asks, quantity);
+}
+
+template <typename Traits>
+FillEstimate BasicOrderbook<Traits>::estimateSell(Quantity quantity) const {
+    if (const DepthLadder* ladder = usableLadder(bidDepth_)) {
+        return ladder->estimateFill(quantity);
+    }
+    return walkFill(bids, quantity);
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::noteDepth(OrderSide side, Price price, Quantity delta) {
+    ++(side == OrderSide::BUY ? bidRevision_ : askRevision_);
+    std::optional<DepthLadder>& ladder = side == OrderSide::BUY ? bidDepth_ : askDepth_;
+    if (ladder) {
+        ladder->add(price, delta);
+    }
+    if (journalDepth_) {
+        depthJournal_.push_back(DepthChange{side, price, delta});
+    }
+}
+
+// Called whenever an order comes to rest; every size read here is O(1).
+template <typename Traits>
+void BasicOrderbook<Traits>::noteFootprint() {
+    peak_.bidLevels = std::max(peak_.bidLevels, bids.size());
+    peak_.askLevels = std::max(peak_.askLevels, asks.size());
+    peak_.orders = std::max(peak_.orders, orders.size());
+    peak_.buckets = std::max(peak_.buckets, orders.bucket_count());
+}
+
+template <typename Traits>
+std::uint64_t BasicOrderbook<Traits>::revision(OrderSide side) const {
+    return side == OrderSide::BUY ? bidRevision_ : askRevision_;
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::enableDepthJournal() {
+    if (journalDepth_) {
+        return;
+    }
+    journalDepth_ = true;
+    for (const auto& [price, level] : bids) {
+        if (level.totalQuantity() != 0) {
+            depthJournal_.push_back(DepthChange{OrderSide::BUY, price, level.totalQuantity()});
+        }
+    }
+    for (const auto& [price, level] : asks) {
+        if (level.totalQuantity() != 0) {
+            depthJournal_.push_back(DepthChange{OrderSide::SELL, price, level.totalQuantity()});
+        }
+    }
+}
+
+template <typename Traits>
+void BasicOrderbook<Traits>::drainDepthChanges(DepthChanges& out) {
+    out.clear();
+    if (out.get_allocator() == depthJournal_.get_allocator()) {
+        out.swap(depthJournal_);
+    } else {
+        out.assign(depthJournal_.begin(), depthJournal_.end());
+        depthJournal_.clear();
+    }
+}
+
+template <typename Traits>
+BookMemoryStats BasicOrderbook<Traits>::memoryStats() const {
+    using LevelNode = typename Asks::value_type;
+    using IndexNode = typename decltype(orders)::value_type;
+
+    BookMemoryStats stats;
+    // A dead order's index entry is gone early if its ID was reused.
+    stats.restingOrders = orders.size() > tombstones_ ? orders.size() - tombstones_ : 0;
+    stats.tombstones = tombstones_;
+    stats.bidLevels = nodeUsage(bids.size(), peak_.bidLevels, sizeof(LevelNode), MAP_NODE_LINKS);
+    stats.askLevels = nodeUsage(asks.size(), peak_.askLevels, sizeof(LevelNode), MAP_NODE_LINKS);
+    stats.levelQueues = nodeUsage(orders.size(), peak_.orders, sizeof(Record), LIST_NODE_LINKS);
+    stats.orderIndex = nodeUsage(orders.size(), peak_.orders, sizeof(IndexNode), HASH_NODE_LINKS);
+
+    // A single bucket is the container's static placeholder, not a heap block.
+    std::size_t buckets = orders.bucket_count() > 1 ? orders.bucket_count() : 0;
+    std::size_t peakBuckets = peak_.buckets > 1 ? peak_.buckets : 0;
+    stats.orderIndex.bytesReserved += buckets ? allocatedBytes(buckets * sizeof(void*)) : 0;
+    stats.orderIndex.highWaterBytes += peakBuckets ? allocatedBytes(peakBuckets * sizeof(void*)) : 0;
+
+    for (const MemoryUsage* usage : {&stats.bidLevels, &stats.askLevels, &stats.levelQueues, &stats.orderIndex}) {
+        stats.totalBytesUsed += usage->bytesUsed;
+        stats.totalBytesReserved += usage->bytesReserved;
+        stats.highWaterBytes += usage->highWaterBytes;
+    }
+    if (stats.restingOrders > 0) {
+        stats.bytesPerOrder = static_cast<double>(stats.totalBytesReserved) / stats.restingOrders;
+    }
+    return stats;
+}
+
+template class BasicOrderbook<BookTraits<>>;
+template class BasicOrderbook<CompactBookTraits>;
@@ -0,0 +1,223 @@
+#include "RiskGate.h"
+
+namespace {
+
+constexpr Timestamp ONE_SECOND = 1000000000;
+
+const RiskExposure NO_EXPOSURE{};
+
+// Accepted orders in the window containing `now`. A clock that went
+// backwards reads as a fresh window.
+std::uint32_t ordersInWindow(const RiskExposure& exposure, Timestamp now) {
+    return now - exposure.windowStart < ONE_SECOND ? exposure.windowOrders : 0;
+}
+
+} // namespace
+
+const char* riskRejectName(RiskReject reject) {
+    switch (reject) {
+        case RiskReject::NONE: return "NONE";
+        case RiskReject::ORDER_QUANTITY: return "ORDER_QUANTITY";
+        case RiskReject::OPEN_NOTIONAL: return "OPEN_NOTIONAL";
+        case RiskReject::POSITION: return "POSITION";
+        case RiskReject::ORDER_RATE: return "ORDER_RATE";
+        case RiskReject::DUPLICATE_ORDER_ID: return "DUPLICATE_ORDER_ID";
+        case RiskReject::ACCOUNT_MISMATCH: return "ACCOUNT_MISMATCH";
+    }
+    return "UNKNOWN";
+}
+
+RiskGate::RiskGate(std::pmr::memory_resource* resource)
+    : accounts_(resource), open_(resource), dropped_(resource) {}
+
+void RiskGate::setDefaultLimits(const RiskLimits& limits) {
+    defaultLimits_ = limits;
+}
+
+void RiskGate::setLimits(OwnerID account, const RiskLimits& limits) {
+    this->account(account).limits = limits;
+}
+
+const RiskLimits& RiskGate::limits(OwnerID account) const {
+    auto found = accounts_.find(account);
+    return found != accounts_.end() ? found->second.limits : defaultLimits_;
+}
+
+const RiskExposure* RiskGate::exposure(OwnerID account) const {
+    auto found = accounts_.find(account);
+    return found != accounts_.end() ? &found->second.exposure : nullptr;
+}
+
+RiskReject RiskGate::check(const Order& order, OwnerID account, Timestamp now) const {
+    auto found = accounts_.find(account);
+    const RiskLimits& limits = found != accounts_.end() ? found->second.limits : defaultLimits_;
+    const RiskExposure& exposure = found != accounts_.end() ? found->second.exposure : NO_EXPOSURE;
+    Quantity quantity = order.getQuantity();
+
+    if (limits.maxOrderQuantity > 0 && quantity > limits.maxOrderQuantity) {
+        return RiskReject::ORDER_QUANTITY;
+    }
+    if (limits.maxOrdersPerSecond > 0 && ordersInWindow(exposure, now) >= limits.maxOrdersPerSecond) {
+        return RiskReject::ORDER_RATE;
+    }
+    // Market orders never rest, so they add no open notional.
+    if (limits.maxOpenNotional > 0.0 && order.getType() == OrderType::LIMIT &&
+        exposure.openNotional + order.getPrice() * quantity > limits.maxOpenNotional) {
+        return RiskReject::OPEN_NOTIONAL;
+    }
+    if (limits.maxPosition > 0) {
+        Quantity worst = order.getSide() == OrderSide::BUY
+                             ? exposure.position + exposure.openBuyQuantity + quantity
+                             : exposure.openSellQuantity + quantity - exposure.position;
+        if (worst > limits.maxPosition) {
+            return RiskReject::POSITION;
+        }
+    }
+    return RiskReject::NONE;
+}
+
+void RiskGate::onTrades(const TradeList& trades) {
+    if (open_.empty()) {
+        dropped_.clear();
+        return;
+    }
+    for (const Trade& trade : trades) {
+        fill(trade.getBuyOrder().orderID, OrderSide::BUY, trade.getTradedQuantity());
+        fill(trade.getSellOrder().orderID, OrderSide::SELL, trade.getTradedQuantity());
+    }
+    for (OrderID id : dropped_) {
+        release(open_.find(id));
+    }
+    dropped_.clear();
+}
+
+void RiskGate::reset() {
+    open_.clear();
+    dropped_.clear();
+    for (auto& entry : accounts_) {
+        entry.second.exposure = RiskExposure();
+        entry.second.head = nullptr;
+    }
+}
+
+std::size_t RiskGate::trackedOrderCount() const {
+    return open_.size();
+}
+
+RiskGate::Account& RiskGate::account(OwnerID account) {
+    auto inserted = accounts_.try_emplace(account);
+    if (inserted.second) {
+        inserted.first->second.limits = defaultLimits_;
+    }
+    return inserted.first->second;
+}
+
+void RiskGate::countOrder(Account& owner, Timestamp now) {
+    RiskExposure& exposure = owner.exposure;
+    if (ordersInWindow(exposure, now) == 0) {
+        exposure.windowStart = now;
+        exposure.windowOrders = 0;
+    }
+    ++exposure.windowOrders;
+}
+
+RiskGate::OpenOrders::iterator RiskGate::admit(const Order& order, OwnerID accountId, Timestamp now) {
+    Account& owner = account(accountId);
+    countOrder(owner, now);
+
+    auto inserted = open_.try_emplace(order.getOrderId());
+    if (!inserted.second) {
+        // An ID the book is about to reuse no longer belongs to the old order.
+        release(inserted.first);
+        inserted = open_.try_emplace(order.getOrderId());
+    }
+    Price price = order.getType() == OrderType::LIMIT ? order.getPrice() : 0.0;
+    OpenOrder& open = inserted.first->second;
+    open = OpenOrder{order.getOrderId(), &owner, order.getSide(), price, 0};
+    open.next = owner.head;
+    if (owner.head != nullptr) {
+        owner.head->prev = &open;
+    }
+    owner.head = &open;
+    update(open, order.getQuantity(), price);
+    return inserted.first;
+}
+
+// An untracked order is checked on its own. A tracked one is checked with
+// its current exposure taken out, and on acceptance is tracked at the
+// replacement's full size, ready for the trades it makes.
+RiskReject RiskGate::replace(OpenOrders::iterator it, const Order& replacement, OwnerID accountId, Timestamp now) {
+    if (it == open_.end()) {
+        RiskReject result = check(replacement, accountId, now);
+        if (result == RiskReject::NONE) {
+            countOrder(account(accountId), now);
+        }
+        return result;
+    }
+    OpenOrder& open = it->second;
+    Quantity remaining = open.remaining;
+    Price price = open.price;
+    update(open, 0, price);
+    RiskReject result = check(replacement, accountId, now);
+    if (result != RiskReject::NONE) {
+        update(open, remaining, price);
+        return result;
+    }
+    countOrder(*open.account, now);
+    update(open, replacement.getQuantity(), replacement.getPrice());
+    return result;
+}
+
+void RiskGate::fill(OrderID id, OrderSide side, Quantity quantity) {
+    auto found = open_.find(id);
+    if (found == open_.end() || found->second.side != side) {
+        return;
+    }
+    OpenOrder& open = found->second;
+    open.account->exposure.position += side == OrderSide::BUY ? quantity : -quantity;
+    if (quantity >= open.remaining) {
+        release(found);
+    } else {
+        update(open, open.remaining - quantity, open.price);
+    }
+}
+
+void RiskGate::settle(OpenOrders::iterator it, const Order* resting, bool queued) {
+    if (resting != nullptr) {
+        update(it->second, resting->getQuantity(), resting->getPrice());
+    } else if (!queued) {
+        release(it);
+    }
+}
+
+void RiskGate::update(OpenOrder& open, Quantity remaining, Price price) {
+    RiskExposure& exposure = open.account->exposure;
+    Quantity& sideQuantity = open.side == OrderSide::BUY ? exposure.openBuyQuantity : exposure.openSellQuantity;
+    sideQuantity += remaining - open.remaining;
+    exposure.openNotional += price * remaining - open.price * open.remaining;
+    open.remaining = remaining;
+    open.price = price;
+}
+
+// No-op for end().
+void RiskGate::release(OpenOrders::iterator it) {
+    if (it == open_.end()) {
+        return;
+    }
+    OpenOrder& open = it->second;
+    update(open, 0, open.price);
+    Account& owner = *open.account;
+    if (open.next != nullptr) {
+        open.next->prev = open.prev;
+    }
+    if (open.prev != nullptr) {
+        open.prev->next = open.next;
+    } else {
+        owner.head = open.next;
+    }
+    if (owner.head == nullptr) {
+        // Nothing open: drop the rounding residue of the running sum.
+        owner.exposure.openNotional = 0.0;
+    }
+    open_.erase(it);
+}
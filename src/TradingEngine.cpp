@@ -1,27 +1,27 @@
 #include "TradingEngine.h"
-#include <cstdlib>
-#include <ctime>
 
-#include "TradingEngine.h"
-#include <cstdlib>
-#include <ctime>
+#include <algorithm>
 
-TradingEngine::TradingEngine()
-    : portfolio_(100000.0), nextOrderID_(1), orderGenerator_(orderbook_) {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-}
+// The engine's own draws use stream 1 so they never overlap the generator's.
+TradingEngine::TradingEngine(std::uint64_t seed)
+    : portfolio_(100000.0), nextOrderID_(1), clock_(0), seed_(seed), orderGenerator_(orderbook_, seed), rng_(seed, 1) {}
 
 void TradingEngine::initialize() {
     orderbook_ = Orderbook();
+    riskGate_.reset();
     tradeHistory_.clear();
     portfolio_ = Portfolio(100000.0);
     portfolioValues_.clear();
     nextOrderID_ = 1;
+    clock_ = 0;
+    orderGenerator_.reseed(seed_);
+    rng_.reseed(seed_, 1);
 }
 
 void TradingEngine::runSimulation(int numIterations) {
     for (int i = 0; i < numIterations; ++i) {
-        int numOrders = std::rand() % 10 + 1;
+        clock_ += SIMULATION_STEP;
+        int numOrders = static_cast<int>(rng_.uniform(10)) + 1;
         std::vector<Order> orders = orderGenerator_.generateOrders(numOrders, nextOrderID_);
 
         for (auto& order : orders) {
@@ -47,15 +47,27 @@ void TradingEngine::runSimulation(int numIterations) {
 
 void TradingEngine::processOrder(Order& order) {
     TradeList trades = orderbook_.addOrder(order);
+    riskGate_.onTrades(trades);
     tradeHistory_.insert(tradeHistory_.end(), trades.begin(), trades.end());
 }
 
 void TradingEngine::processPersonalOrder(Order& order) {
-    TradeList trades = orderbook_.addOrder(order);
+    TradeList trades = riskGate_.submit(orderbook_, order, PERSONAL_ACCOUNT, clock_);
     tradeHistory_.insert(tradeHistory_.end(), trades.begin(), trades.end());
     portfolio_.update(trades);
 }
 
+void TradingEngine::processCommand(OrderCommand& command) {
+    clock_ = std::max(clock_, command.timestamp);
+    TradeList trades = applyCommand(orderbook_, command);
+    riskGate_.onTrades(trades);
+    if (command.type != CommandType::NEW) {
+        // A cancel or amend may have touched one of our own orders.
+        riskGate_.sync(orderbook_, command.order.getOrderId());
+    }
+    tradeHistory_.insert(tradeHistory_.end(), trades.begin(), trades.end());
+}
+
 const TradeList& TradingEngine::getTradeHistory() const {
     return tradeHistory_;
 }
@@ -0,0 +1,172 @@
+#include "WorkloadGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config, OrderID firstOrderID)
+    : config_(config), rng_(config.seed), nextOrderID_(firstOrderID),
+      midTicks_(std::round(config.initialMidPrice / config.tickSize)) {}
+
+const WorkloadConfig& WorkloadGenerator::config() const {
+    return config_;
+}
+
+std::size_t WorkloadGenerator::liveOrderCount() const {
+    return live_.size();
+}
+
+std::vector<OrderCommand> WorkloadGenerator::generate(std::size_t count) {
+    std::vector<OrderCommand> commands(count);
+    generateInto(commands.data(), count);
+    return commands;
+}
+
+void WorkloadGenerator::generateInto(OrderCommand* commands, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        commands[i] = next();
+    }
+}
+
+OrderCommand WorkloadGenerator::next() {
+    Timestamp timestamp = nextArrival();
+
+    // Triangular noise (two uniforms) scaled to unit variance stands in for a
+    // Gaussian step at a fraction of the cost.
+    midTicks_ += (rng_.uniformDouble() + rng_.uniformDouble() - 1.0) * config_.midDriftTicks * 2.449;
+
+    OrderCommand command;
+    double u = rng_.uniformDouble();
+    bool warm = !live_.empty() && live_.size() >= config_.minLiveOrders;
+    if (warm && u < config_.cancelRatio) {
+        command = makeCancel();
+    } else if (warm && u < config_.cancelRatio + config_.amendRatio) {
+        command = makeAmend();
+    } else {
+        command = makeNew();
+    }
+    command.timestamp = timestamp;
+    return command;
+}
+
+// Ogata thinning: the intensity only decays between events, so its current
+// value bounds it until the next arrival.
+Timestamp WorkloadGenerator::nextArrival() {
+    double base = config_.baseRatePerSecond;
+    double jump = config_.branchingRatio * config_.decayPerSecond;
+    while (true) {
+        double bound = base + excitation_;
+        double dt = -std::log(1.0 - rng_.uniformDouble()) / bound;
+        timeSeconds_ += dt;
+        excitation_ *= std::exp(-config_.decayPerSecond * dt);
+        if (rng_.uniformDouble() * bound <= base + excitation_) {
+            excitation_ += jump;
+            return static_cast<Timestamp>(timeSeconds_ * 1e9);
+        }
+    }
+}
+
+Quantity WorkloadGenerator::drawSize() {
+    double u = 1.0 - rng_.uniformDouble();
+    double size = config_.minSize * std::pow(u, -1.0 / config_.sizeTailExponent);
+    return std::min(config_.maxSize, std::max(config_.minSize, static_cast<Quantity>(size)));
+}
+
+std::int64_t WorkloadGenerator::drawTicksFromTouch() {
+    // Geometric on {0, 1, ...} with the configured mean.
+    double p = 1.0 / (1.0 + config_.meanTicksFromTouch);
+    double u = 1.0 - rng_.uniformDouble();
+    return static_cast<std::int64_t>(std::floor(std::log(u) / std::log(1.0 - p)));
+}
+
+// Positive ticks are passive (away from the other side), negative cross it.
+Price WorkloadGenerator::priceAtTicks(std::int64_t ticksFromTouch, OrderSide side) const {
+    double touch = std::round(midTicks_);
+    double ticks = (side == OrderSide::BUY) ? touch - 1 - ticksFromTouch : touch + 1 + ticksFromTouch;
+    return std::max(1.0, ticks) * config_.tickSize;
+}
+
+std::size_t WorkloadGenerator::pickLive() {
+    return static_cast<std::size_t>(rng_.uniform(live_.size()));
+}
+
+OrderCommand WorkloadGenerator::makeNew() {
+    OrderSide side = rng_.uniform(2) == 0 ? OrderSide::BUY : OrderSide::SELL;
+    Quantity quantity = drawSize();
+
+    double u = rng_.uniformDouble();
+    OrderType type = OrderType::LIMIT;
+    DurationType duration = DurationType::GOOD_TILL_CANCELLED;
+    if (u < config_.marketRatio) {
+        type = OrderType::MARKET;
+        duration = DurationType::IMMEDIATE_OR_CANCEL;
+    } else if (u < config_.marketRatio + config_.immediateOrCancelRatio) {
+        duration = DurationType::IMMEDIATE_OR_CANCEL;
+    } else if (u < config_.marketRatio + config_.immediateOrCancelRatio + config_.fillOrKillRatio) {
+        duration = DurationType::FILL_OR_KILL;
+    }
+
+    std::int64_t ticks = drawTicksFromTouch();
+    bool aggressive = duration != DurationType::GOOD_TILL_CANCELLED || rng_.uniformDouble() < config_.aggressiveRatio;
+    Price price = type == OrderType::MARKET ? 0.0 : priceAtTicks(aggressive ? -2 - ticks : ticks, side);
+
+    OrderCommand command;
+    command.type = CommandType::NEW;
+    command.order = Order(nextOrderID_++, quantity, price, type, side, duration);
+    if (type == OrderType::LIMIT && duration == DurationType::GOOD_TILL_CANCELLED) {
+        live_.push_back(command.order.getOrderId());
+        liveSides_.push_back(side);
+    }
+    return command;
+}
+
+OrderCommand WorkloadGenerator::makeCancel() {
+    std::size_t index = pickLive();
+    OrderCommand command;
+    command.type = CommandType::CANCEL;
+    command.order = Order(live_[index], 0, 0.0, OrderType::LIMIT, liveSides_[index], DurationType::GOOD_TILL_CANCELLED);
+
+    live_[index] = live_.back();
+    live_.pop_back();
+    liveSides_[index] = liveSides_.back();
+    liveSides_.pop_back();
+    return command;
+}
+
+OrderCommand WorkloadGenerator::makeAmend() {
+    std::size_t index = pickLive();
+    OrderSide side = liveSides_[index];
+    OrderCommand command;
+    command.type = CommandType::AMEND;
+    command.order = Order(live_[index], drawSize(), priceAtTicks(drawTicksFromTouch(), side),
+                          OrderType::LIMIT, side, DurationType::GOOD_TILL_CANCELLED);
+    return command;
+}
+
+namespace {
+
+TradeList applyToBook(Orderbook& book, OrderCommand& command) {
+    OrderID id = command.order.getOrderId();
+    switch (command.type) {
+        case CommandType::NEW:
+            return book.addOrder(command.order);
+        case CommandType::CANCEL:
+            book.cancelOrder(id);
+            return TradeList();
+        case CommandType::AMEND:
+            return book.amendOrder(id, command.order.getQuantity(), command.order.getPrice());
+    }
+    return TradeList();
+}
+
+} // namespace
+
+TradeList applyCommand(Orderbook& book, OrderCommand& command) {
+    if (!book.batching()) {
+        return applyToBook(book, command);
+    }
+    // A batch whose window ended before this command clears first.
+    TradeList trades = book.advanceClock(command.timestamp);
+    TradeList more = applyToBook(book, command);
+    trades.insert(trades.end(), more.begin(), more.end());
+    return trades;
+}
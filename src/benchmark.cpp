@@ -1,165 +1,334 @@
 #include <iostream>
-#include <chrono>
+#include <string>
+#include <vector>
 #include "OrderTypes.h"
 #include "Orderbook.h"
 #include "OrderGenerator.h"
+#include "WorkloadGenerator.h"
+#include "BenchmarkHarness.h"
+#include "Random.h"
+#include "PerfCounters.h"
+#include "MemoryResources.h"
 
 using namespace std;
-using namespace std::chrono;
 
-// measures time for 3000 orders in nanoseconds
-void benchmarkMatch3000Orders() {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID id = 0;
-    auto orders = generator.generateOrders(100, id);
+// Every benchmark builds its whole workload before the clock starts, runs a
+// warm-up pass on a throwaway book, then times each operation individually
+// with the cycle counter so we get a latency distribution, not just a mean.
+
+const Price MID_PRICE = 100.0;
+const Price TICK = 0.01;
+
+struct BenchmarkOptions {
+    size_t operations = 200000;
+    size_t warmup = 20000;
+    string jsonPath = "benchmark_results.json";
+    string label = "default";
+    PerfCounters* perf = nullptr;  // set by --perf when counters can be opened
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource();  // --memory heap|pool|arena
+};
+
+// Resting limit orders 1..depth ticks away from the mid on both sides, so
+// they never cross each other.
+vector<Order> makePassiveOrders(size_t count, OrderID& nextOrderID, Xoshiro256& rng, int depth = 50) {
+    vector<Order> orders;
+    orders.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        OrderSide side = rng.uniform(2) == 0 ? OrderSide::BUY : OrderSide::SELL;
+        int ticks = static_cast<int>(rng.uniform(depth)) + 1;
+        Price price = MID_PRICE + (side == OrderSide::BUY ? -ticks : ticks) * TICK;
+        Quantity qty = rng.uniform(100) + 1;
+        orders.emplace_back(nextOrderID++, qty, price, OrderType::LIMIT, side, DurationType::GOOD_TILL_CANCELLED);
+    }
+    return orders;
+}
 
-    auto start = high_resolution_clock::now();
+void populate(Orderbook& book, vector<Order> orders) {
     for (auto &order : orders) {
         book.addOrder(order);
     }
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<microseconds>(end - start).count();
-
-    cout << "Time taken to match 3,000 orders (NASDAQ's average volume per second): " << (float)duration / 1000000 << " s" << endl;
 }
 
-// measures time for a million orders in milliseconds (then convert to seconds)
-void benchmarkMatchMillionOrders() {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID id = 0;
-    auto orders = generator.generateOrders(1000000, id);
+// measures adding resting orders to a book that already holds liquidity
+BenchmarkResult benchmarkAdd(const BenchmarkOptions& options) {
+    Xoshiro256 rng(1);
+    OrderID id = 1;
+    vector<Order> seed = makePassiveOrders(10000, id, rng);
+    vector<Order> warm = makePassiveOrders(options.warmup, id, rng);
+    vector<Order> orders = makePassiveOrders(options.operations, id, rng);
 
-    auto start = high_resolution_clock::now();
+    Orderbook warmBook(options.memory);
+    populate(warmBook, seed);
+    populate(warmBook, warm);
+
+    Orderbook book(options.memory);
+    populate(book, seed);
+    LatencyRecorder recorder(orders.size());
+    CounterRegion counters(options.perf);
     for (auto &order : orders) {
-        book.addOrder(order);
+        uint64_t start = readCycles();
+        TradeList trades = book.addOrder(order);
+        uint64_t end = readCycles();
+        doNotOptimize(trades);
+        recorder.record(end - start);
     }
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<milliseconds>(end - start).count();
-
-    cout << "Time taken to match 1,000,000 orders: " << (float)duration / 1000 << " s" << endl;
+    counters.stop();
+    return counters.attach(recorder.summarize("add_resting"));
 }
 
-// measures number of orders processed in 5 seconds
-void benchmarkOrdersProcessedIn5Seconds() {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID id = 0;
+// measures cancelling resting orders in random order, optionally with lazy
+// (tombstone) cancellation
+BenchmarkResult benchmarkCancel(const BenchmarkOptions& options, bool lazy = false) {
+    Xoshiro256 rng(2);
+    OrderID id = 1;
+    vector<Order> orders = makePassiveOrders(options.operations + options.warmup, id, rng);
+    vector<OrderID> ids;
+    ids.reserve(orders.size());
+    for (auto &order : orders) {
+        ids.push_back(order.getOrderId());
+    }
+    for (size_t i = ids.size(); i > 1; --i) {
+        swap(ids[i - 1], ids[rng.uniform(i)]);
+    }
 
-    auto start = high_resolution_clock::now();
-    int orderCount = 0;
-    while (duration_cast<seconds>(high_resolution_clock::now() - start).count() < 5) {
-        auto orders = generator.generateOrders(1, id); // maybe this shouldn't be part of the benchmark...
-        book.addOrder(orders[0]);
-        orderCount++;
+    Orderbook book(options.memory);
+    book.setLazyCancel(lazy);
+    populate(book, orders);
+    for (size_t i = 0; i < options.warmup; ++i) {
+        book.cancelOrder(ids[i]);
     }
 
-    cout << "Orders processed in 5 seconds: " << orderCount << endl;
+    LatencyRecorder recorder(options.operations);
+    CounterRegion counters(options.perf);
+    for (size_t i = options.warmup; i < ids.size(); ++i) {
+        uint64_t start = readCycles();
+        bool success = book.cancelOrder(ids[i]);
+        uint64_t end = readCycles();
+        doNotOptimize(success);
+        recorder.record(end - start);
+    }
+    counters.stop();
+    return counters.attach(recorder.summarize(lazy ? "cancel_random_lazy" : "cancel_random"));
 }
 
-// measures number of orders processed in a second
-void benchmarkOrdersProcessedIn1Second() {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID id = 0;
+// measures small aggressive limit orders that fill against the touch
+BenchmarkResult benchmarkMatch(const BenchmarkOptions& options) {
+    Xoshiro256 rng(3);
+    OrderID id = 1;
+    size_t total = options.operations + options.warmup;
 
-    auto start = high_resolution_clock::now();
-    int orderCount = 0;
-    while (duration_cast<seconds>(high_resolution_clock::now() - start).count() < 1) {
-        auto orders = generator.generateOrders(1, id);
-        book.addOrder(orders[0]);
-        orderCount++;
+    // Each incoming order takes at most 10 lots, so 100-lot resting orders
+    // on each side outlast the run and every operation actually matches.
+    vector<Order> resting;
+    resting.reserve(total / 5 + 2);
+    for (size_t i = 0; i < total / 10 + 1; ++i) {
+        int ticks = static_cast<int>(i % 20) + 1;
+        resting.emplace_back(id++, 100, MID_PRICE + ticks * TICK, OrderType::LIMIT, OrderSide::SELL, DurationType::GOOD_TILL_CANCELLED);
+        resting.emplace_back(id++, 100, MID_PRICE - ticks * TICK, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED);
+    }
+    vector<Order> incoming;
+    incoming.reserve(total);
+    for (size_t i = 0; i < total; ++i) {
+        OrderSide side = rng.uniform(2) == 0 ? OrderSide::BUY : OrderSide::SELL;
+        Price price = MID_PRICE + (side == OrderSide::BUY ? 21 : -21) * TICK;
+        incoming.emplace_back(id++, rng.uniform(10) + 1, price, OrderType::LIMIT, side, DurationType::IMMEDIATE_OR_CANCEL);
     }
 
-    cout << "Orders processed in 1 second: " << orderCount << endl;
+    Orderbook book(options.memory);
+    populate(book, resting);
+    for (size_t i = 0; i < options.warmup; ++i) {
+        book.addOrder(incoming[i]);
+    }
+
+    LatencyRecorder recorder(options.operations);
+    CounterRegion counters(options.perf);
+    for (size_t i = options.warmup; i < total; ++i) {
+        uint64_t start = readCycles();
+        TradeList trades = book.addOrder(incoming[i]);
+        uint64_t end = readCycles();
+        doNotOptimize(trades);
+        recorder.record(end - start);
+    }
+    counters.stop();
+    return counters.attach(recorder.summarize("match_touch"));
 }
 
-// measures number of orders processed in a single millisecond
-void benchmarkOrdersProcessedIn1Millisecond() {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID id = 0;
+// measures market orders that sweep `levels` full price levels; the levels
+// are rebuilt untimed before every sweep
+BenchmarkResult benchmarkSweep(const BenchmarkOptions& options, int levels, int ordersPerLevel) {
+    size_t sweeps = options.operations / 20;
+    size_t warmup = options.warmup / 20;
+    OrderID id = 1;
+    Quantity lot = 10;
 
-    auto start = high_resolution_clock::now();
-    int orderCount = 0;
-    while (duration_cast<milliseconds>(high_resolution_clock::now() - start).count() < 1) {
-        auto orders = generator.generateOrders(1, id);
-        book.addOrder(orders[0]);
-        orderCount++;
+    Orderbook book(options.memory);
+    LatencyRecorder recorder(sweeps);
+    CounterRegion counters(options.perf);
+    counters.stop();
+    vector<Order> ladder;
+    ladder.reserve(levels * ordersPerLevel);
+    for (size_t i = 0; i < sweeps + warmup; ++i) {
+        ladder.clear();
+        for (int level = 1; level <= levels; ++level) {
+            for (int k = 0; k < ordersPerLevel; ++k) {
+                ladder.emplace_back(id++, lot, MID_PRICE + level * TICK, OrderType::LIMIT, OrderSide::SELL, DurationType::GOOD_TILL_CANCELLED);
+            }
+        }
+        populate(book, ladder);
+        MarketOrder sweep(id++, lot * levels * ordersPerLevel, OrderSide::BUY);
+
+        bool measured = i >= warmup;
+        if (measured) counters.resume();
+        uint64_t start = readCycles();
+        TradeList trades = book.addOrder(sweep);
+        uint64_t end = readCycles();
+        if (measured) counters.stop();
+        doNotOptimize(trades);
+        if (measured) {
+            recorder.record(end - start);
+        }
     }
+    return counters.attach(recorder.summarize("sweep_" + to_string(levels) + "x" + to_string(ordersPerLevel)));
+}
 
-    cout << "Orders processed in 1 millisecond: " << orderCount << endl;
+// measures a realistic cancel/amend-heavy command stream, matched
+// continuously or, with a batch config, in frequent batch auctions
+BenchmarkResult benchmarkWorkload(const BenchmarkOptions& options, const BatchConfig& batch = BatchConfig()) {
+    WorkloadGenerator generator;
+    vector<OrderCommand> warm = generator.generate(options.warmup);
+    vector<OrderCommand> commands = generator.generate(options.operations);
+
+    Orderbook book(options.memory);
+    book.setBatchMode(batch);
+    for (auto &command : warm) {
+        applyCommand(book, command);
+    }
+
+    LatencyRecorder recorder(commands.size());
+    CounterRegion counters(options.perf);
+    for (auto &command : commands) {
+        uint64_t start = readCycles();
+        TradeList trades = applyCommand(book, command);
+        uint64_t end = readCycles();
+        doNotOptimize(trades);
+        recorder.record(end - start);
+    }
+    counters.stop();
+    return counters.attach(recorder.summarize(book.batching() ? "workload_batched" : "workload_mixed"));
 }
 
-// measures how fast a single order can be added
-void benchmarkAddSingleOrder() {
-    Orderbook book;
-    OrderGenerator generator;
+// measures bulk throughput of pre-generated random orders (no per-op timing)
+BenchmarkResult benchmarkThroughput(const BenchmarkOptions& options) {
+    Orderbook book(options.memory);
+    OrderGenerator generator(book);
     OrderID id = 0;
-    auto orders = generator.generateOrders(1, id);
+    vector<Order> orders(options.operations);
+    generator.generateInto(orders.data(), orders.size(), id);
 
-    auto start = high_resolution_clock::now();
-    book.addOrder(orders[0]);
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<nanoseconds>(end - start).count();
+    CounterRegion counters(options.perf);
+    uint64_t start = readCycles();
+    for (auto &order : orders) {
+        TradeList trades = book.addOrder(order);
+        doNotOptimize(trades);
+    }
+    uint64_t end = readCycles();
+    counters.stop();
 
-    cout << "Time taken to add a single order: " << duration << " ns" << endl;
+    BenchmarkResult result;
+    result.name = "throughput_random";
+    result.operations = orders.size();
+    result.seconds = (end - start) / cyclesPerNanosecond() / 1e9;
+    result.opsPerSecond = orders.size() / result.seconds;
+    result.meanNs = result.seconds * 1e9 / orders.size();
+    return counters.attach(result);
 }
 
-// measures how fast a single order can be canceled
-void benchmarkCancelSingleOrder() {
-    Orderbook book;
-    LimitOrder order(1, 10, 100.0, OrderSide::BUY);
-    book.addOrder(order);
-    OrderID orderId = order.getOrderId();
+// measures one uncross of a call auction holding every order of the run,
+// buys and sells spread over the same 50 ticks either side of the mid
+BenchmarkResult benchmarkAuction(const BenchmarkOptions& options) {
+    Xoshiro256 rng(5);
+    vector<Order> orders;
+    orders.reserve(options.operations);
+    for (OrderID id = 1; id <= options.operations; ++id) {
+        OrderSide side = rng.uniform(2) == 0 ? OrderSide::BUY : OrderSide::SELL;
+        Price price = MID_PRICE + (static_cast<int>(rng.uniform(101)) - 50) * TICK;
+        orders.emplace_back(id, rng.uniform(100) + 1, price, OrderType::LIMIT, side, DurationType::GOOD_TILL_CANCELLED);
+    }
 
-    auto start = high_resolution_clock::now();
-    bool success = book.cancelOrder(orderId);
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<nanoseconds>(end - start).count();
+    Orderbook book(options.memory);
+    book.beginAuction();
+    populate(book, orders);
 
-    if (success) {
-        cout << "Time taken to cancel a single order: " << duration << " ns" << endl;
-    } else {
-        cout << "Failed to cancel order!" << endl;
-    }
+    CounterRegion counters(options.perf);
+    uint64_t start = readCycles();
+    AuctionResult auction = book.uncross(MID_PRICE);
+    uint64_t end = readCycles();
+    counters.stop();
+    doNotOptimize(auction);
+
+    BenchmarkResult result;
+    result.name = "auction_uncross";
+    result.operations = orders.size();
+    result.seconds = (end - start) / cyclesPerNanosecond() / 1e9;
+    result.opsPerSecond = orders.size() / result.seconds;
+    result.meanNs = result.seconds * 1e9 / orders.size();
+    return counters.attach(result);
 }
 
-// performs a MIX of half market orders and half limit orders
-void benchmarkMixedOrderMatching(int numOrders) {
-    Orderbook book;
-    OrderGenerator generator;
-    OrderID idLimit = 0;
-    OrderID idMarket = numOrders / 2;
-    auto limitOrders = generator.generateOrders(numOrders / 2, idLimit);
-    generator.setType(OrderType::MARKET);
-    auto marketOrders = generator.generateOrders(numOrders / 2, idMarket);
-
-    auto start = high_resolution_clock::now();
-    for (auto &order : limitOrders) {
-        book.addOrder(order);
-    }
-    for (auto &order : marketOrders) {
-        book.addOrder(order);
+BenchmarkOptions parseOptions(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--perf") {
+            static PerfCounters perf;
+            if (perf.available()) {
+                options.perf = &perf;
+            } else {
+                cerr << "Hardware counters unavailable (check perf_event_paranoid or container seccomp); "
+                     << "reporting timings only" << endl;
+            }
+            continue;
+        }
+        if (i + 1 >= argc) break;
+        if (flag == "--memory") {
+            static BookPool pool;
+            static BookArena arena;
+            string kind = argv[i + 1];
+            if (kind == "pool") options.memory = pool.resource();
+            else if (kind == "arena") options.memory = arena.resource();
+        }
+        else if (flag == "--json") options.jsonPath = argv[i + 1];
+        else if (flag == "--label") options.label = argv[i + 1];
+        else if (flag == "--ops") options.operations = stoul(argv[i + 1]);
+        else if (flag == "--warmup") options.warmup = stoul(argv[i + 1]);
+        ++i;
     }
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<milliseconds>(end - start).count();
-    cout << "Time taken to match " << numOrders << " mixed orders: " << (float)duration / 1000 << " s" << endl;
+    return options;
 }
 
-int main() {
-    cout << "Starting benchmarks..." << endl;
+int main(int argc, char** argv) {
+    BenchmarkOptions options = parseOptions(argc, argv);
+    cout << "Starting benchmarks (" << cyclesPerNanosecond() << " cycles/ns)..." << endl;
+
+    vector<BenchmarkResult> results;
+    printResultHeader();
+    auto run = [&](BenchmarkResult result) {
+        printResult(result);
+        results.push_back(result);
+    };
 
-    benchmarkMatch3000Orders();
-    benchmarkMatchMillionOrders();
-    benchmarkOrdersProcessedIn5Seconds();
-    benchmarkOrdersProcessedIn1Second();
-    benchmarkOrdersProcessedIn1Millisecond();
-    benchmarkAddSingleOrder();
-    benchmarkCancelSingleOrder();
-    benchmarkMixedOrderMatching(3000);
+    run(benchmarkAdd(options));
+    run(benchmarkCancel(options));
+    run(benchmarkCancel(options, true));
+    run(benchmarkMatch(options));
+    run(benchmarkSweep(options, 10, 5));
+    run(benchmarkSweep(options, 100, 1));
+    run(benchmarkWorkload(options));
+    run(benchmarkWorkload(options, BatchConfig{256, 1000000}));
+    run(benchmarkThroughput(options));
+    run(benchmarkAuction(options));
 
-    cout << "Benchmarks completed." << endl;
+    writeResultsJson(options.jsonPath, options.label, results);
+    cout << "Benchmarks completed; results written to " << options.jsonPath << endl;
     return 0;
 }
@@ -0,0 +1,371 @@
+#include <cmath>
+#include <fstream>
+#include <malloc.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "OrderTypes.h"
+#include "Orderbook.h"
+#include "BenchmarkHarness.h"
+#include "DepthSnapshot.h"
+#include "Random.h"
+
+using namespace std;
+
+// Measures how add/cancel/sweep latency scales with the number of resting
+// orders. Each book is pre-populated, then every operation is timed on its
+// own and immediately undone untimed, so the book stays at the target depth
+// for the whole measurement.
+
+const Price MID_PRICE = 1000.0;
+const Price TICK = 0.01;
+
+struct BookShape {
+    string name;
+    size_t ordersPerLevel;  // queue length at each price
+    int tickGap;            // ticks between occupied levels (1 = dense)
+};
+
+struct DepthOptions {
+    int minExponent = 2;
+    int maxExponent = 6;
+    size_t samples = 2000;
+    string jsonPath = "depth_results.json";
+    string csvPath = "depth_results.csv";
+    string label = "default";
+};
+
+struct DepthPoint {
+    string shape;
+    size_t restingOrders;
+    BenchmarkResult result;
+};
+
+class DepthBench {
+public:
+    DepthBench(const BookShape& shape, size_t restingOrders)
+        : shape_(shape), rng_(restingOrders * 31 + shape.ordersPerLevel) {
+        size_t levelsPerSide = max<size_t>(1, restingOrders / 2 / shape.ordersPerLevel);
+        levelsPerSide_ = static_cast<int>(levelsPerSide);
+        ids_.reserve(restingOrders);
+        for (size_t level = 0; level < levelsPerSide; ++level) {
+            for (size_t k = 0; k < shape.ordersPerLevel; ++k) {
+                addResting(OrderSide::BUY, levelPrice(OrderSide::BUY, static_cast<int>(level)));
+                addResting(OrderSide::SELL, levelPrice(OrderSide::SELL, static_cast<int>(level)));
+            }
+        }
+    }
+
+    const Orderbook& book() const {
+        return book_;
+    }
+
+    // joins the queue at the best bid
+    BenchmarkResult insertAtTouch(size_t samples) {
+        LatencyRecorder recorder(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            LimitOrder order(nextId_++, 10, book_.getHighestBid(), OrderSide::BUY);
+            timeAdd(order, recorder);
+            OrderID id = order.getOrderId();
+            book_.cancelOrder(id);
+        }
+        return recorder.summarize("insert_touch");
+    }
+
+    // lands on a random tick inside the populated range; in sparse books
+    // this usually creates a new level
+    BenchmarkResult insertDeep(size_t samples) {
+        LatencyRecorder recorder(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            int ticks = 1 + static_cast<int>(rng_.uniform(levelsPerSide_ * shape_.tickGap));
+            LimitOrder order(nextId_++, 10, MID_PRICE - ticks * TICK, OrderSide::BUY);
+            timeAdd(order, recorder);
+            OrderID id = order.getOrderId();
+            book_.cancelOrder(id);
+        }
+        return recorder.summarize("insert_deep");
+    }
+
+    BenchmarkResult cancelRandom(size_t samples) {
+        LatencyRecorder recorder(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            size_t index = rng_.uniform(ids_.size());
+            OrderID id = ids_[index];
+            const Order* resting = book_.getOrder(id);
+            ids_[index] = ids_.back();
+            ids_.pop_back();
+            if (resting == nullptr) {
+                --i;
+                continue;
+            }
+            Order copy = *resting;
+
+            uint64_t start = readCycles();
+            bool success = book_.cancelOrder(id);
+            uint64_t end = readCycles();
+            doNotOptimize(success);
+            recorder.record(end - start);
+
+            addResting(copy.getSide(), copy.getPrice());
+        }
+        return recorder.summarize("cancel_random");
+    }
+
+    // cancels the order at the head of the best bid queue
+    BenchmarkResult cancelFront(size_t samples) {
+        LatencyRecorder recorder(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            const auto& best = *book_.getBids().begin();
+            OrderID id = best.second.front().getOrderId();
+            Price price = best.first;
+
+            uint64_t start = readCycles();
+            bool success = book_.cancelOrder(id);
+            uint64_t end = readCycles();
+            doNotOptimize(success);
+            recorder.record(end - start);
+
+            // The cancelled id stays in ids_; cancelRandom skips stale ids.
+            addResting(OrderSide::BUY, price);
+        }
+        return recorder.summarize("cancel_front");
+    }
+
+    // market sell that consumes `levels` complete bid levels
+    BenchmarkResult sweep(size_t samples, int levels) {
+        LatencyRecorder recorder(samples);
+        vector<Order> consumed;
+        for (size_t i = 0; i < samples; ++i) {
+            consumed.clear();
+            Quantity total = 0;
+            int taken = 0;
+            for (auto it = book_.getBids().begin(); it != book_.getBids().end() && taken < levels; ++it, ++taken) {
+                for (const RestingOrder& order : it->second) {
+                    consumed.emplace_back(order.getOrderId(), order.getQuantity(), it->first, OrderType::LIMIT,
+                                          OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED);
+                    total += order.getQuantity();
+                }
+            }
+            MarketOrder sweepOrder(nextId_++, total, OrderSide::SELL);
+
+            uint64_t start = readCycles();
+            TradeList trades = book_.addOrder(sweepOrder);
+            uint64_t end = readCycles();
+            doNotOptimize(trades);
+            recorder.record(end - start);
+
+            // Restore the swept levels with their original IDs and sizes.
+            for (Order& order : consumed) {
+                book_.addOrder(order);
+            }
+        }
+        return recorder.summarize("sweep_" + to_string(levels) + "_levels");
+    }
+
+    // VWAP of buying half the ask side, by walking the levels or through
+    // the depth index. The index, once enabled, stays on for later calls.
+    BenchmarkResult fillEstimate(size_t samples, bool indexed) {
+        if (indexed && !book_.depthIndexed()) {
+            book_.enableDepthIndex(TICK);
+        }
+        LatencyRecorder recorder(samples);
+        Quantity half = book_.getSellInterest() / 2;
+        for (size_t i = 0; i < samples; ++i) {
+            Quantity quantity = 1 + rng_.uniform(half);
+            uint64_t start = readCycles();
+            FillEstimate estimate = book_.estimateBuy(quantity);
+            uint64_t end = readCycles();
+            doNotOptimize(estimate);
+            recorder.record(end - start);
+        }
+        return recorder.summarize(indexed ? "fill_estimate_indexed" : "fill_estimate_walk");
+    }
+
+    // republishes the full ladder after a change to the bid side; the ask
+    // side is carried over from the previous snapshot
+    BenchmarkResult depthSnapshot(size_t samples) {
+        DepthSnapshotPublisher feed;
+        feed.publish(book_);
+        LatencyRecorder recorder(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            LimitOrder order(nextId_++, 10, book_.getHighestBid(), OrderSide::BUY);
+            book_.addOrder(order);
+            uint64_t start = readCycles();
+            bool published = feed.publish(book_);
+            uint64_t end = readCycles();
+            doNotOptimize(published);
+            recorder.record(end - start);
+            OrderID id = order.getOrderId();
+            book_.cancelOrder(id);
+        }
+        return recorder.summarize("depth_snapshot");
+    }
+
+private:
+    Price levelPrice(OrderSide side, int level) const {
+        int ticks = 1 + level * shape_.tickGap;
+        return MID_PRICE + (side == OrderSide::BUY ? -ticks : ticks) * TICK;
+    }
+
+    OrderID addOrder(OrderSide side, Price price) {
+        LimitOrder order(nextId_++, rng_.uniform(100) + 1, price, side);
+        book_.addOrder(order);
+        return order.getOrderId();
+    }
+
+    void addResting(OrderSide side, Price price) {
+        ids_.push_back(addOrder(side, price));
+    }
+
+    void timeAdd(Order& order, LatencyRecorder& recorder) {
+        uint64_t start = readCycles();
+        TradeList trades = book_.addOrder(order);
+        uint64_t end = readCycles();
+        doNotOptimize(trades);
+        recorder.record(end - start);
+    }
+
+    BookShape shape_;
+    Xoshiro256 rng_;
+    Orderbook book_;
+    vector<OrderID> ids_;
+    int levelsPerSide_ = 1;
+    OrderID nextId_ = 1;
+};
+
+// One row per (shape, operation): p50 for every depth plus a log-scale bar
+// of the deepest point relative to the shallowest, so growth stands out.
+void printChart(const vector<DepthPoint>& points, const DepthOptions& options) {
+    cout << "\np50 latency (ns) by resting orders" << endl;
+    cout << left << setw(34) << "shape/operation" << right;
+    for (int e = options.minExponent; e <= options.maxExponent; ++e) {
+        cout << setw(9) << ("1e" + to_string(e));
+    }
+    cout << "  growth" << endl;
+
+    for (size_t i = 0; i < points.size();) {
+        string key = points[i].shape + "/" + points[i].result.name;
+        cout << left << setw(34) << key << right << fixed << setprecision(0);
+        for (int e = options.minExponent; pow(10, e) < points[i].restingOrders; ++e) {
+            cout << setw(9) << "-";
+        }
+        double first = points[i].result.p50Ns, last = first;
+        size_t j = i;
+        for (; j < points.size() && points[j].shape + "/" + points[j].result.name == key; ++j) {
+            cout << setw(9) << points[j].result.p50Ns;
+            last = points[j].result.p50Ns;
+        }
+        double ratio = first > 0 ? last / first : 1.0;
+        int bars = max(0, static_cast<int>(round(log2(max(ratio, 1.0)) * 2)));
+        cout << "  " << string(bars, '#') << " x" << setprecision(1) << ratio << endl;
+        i = j;
+    }
+}
+
+// Footprint of each shape at the deepest point, scaled to one million resting
+// orders. "heap" is the measured growth of the malloc arena while the book
+// was built, as a cross-check on the book's own accounting.
+void printMemory(const vector<BookShape>& shapes, const DepthOptions& options) {
+    size_t resting = static_cast<size_t>(pow(10, options.maxExponent));
+    cout << "\nMemory per million resting orders (MiB), measured at " << resting << " orders" << endl;
+    cout << left << setw(14) << "shape" << right << setw(9) << "levels" << setw(9) << "index"
+         << setw(9) << "queues" << setw(9) << "used" << setw(10) << "reserved" << setw(9) << "heap"
+         << setw(11) << "peak" << setw(11) << "B/order" << endl;
+
+    for (const BookShape& shape : shapes) {
+        if (resting < 2 * shape.ordersPerLevel) continue;
+        size_t heapBefore = mallinfo2().uordblks;
+        DepthBench bench(shape, resting);
+        size_t heapAfter = mallinfo2().uordblks;
+
+        BookMemoryStats stats = bench.book().memoryStats();
+        double scale = 1e6 / max<size_t>(1, stats.restingOrders) / (1024.0 * 1024.0);
+        size_t levelBytes = stats.bidLevels.bytesReserved + stats.askLevels.bytesReserved;
+        cout << left << setw(14) << shape.name << right << fixed << setprecision(1)
+             << setw(9) << levelBytes * scale << setw(9) << stats.orderIndex.bytesReserved * scale
+             << setw(9) << stats.levelQueues.bytesReserved * scale << setw(9) << stats.totalBytesUsed * scale
+             << setw(10) << stats.totalBytesReserved * scale << setw(9) << (heapAfter - heapBefore) * scale
+             << setw(11) << stats.highWaterBytes * scale << setw(11) << stats.bytesPerOrder << endl;
+    }
+}
+
+void writeCsv(const string& path, const vector<DepthPoint>& points) {
+    ofstream out(path);
+    out << "shape,resting_orders,operation,samples,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n";
+    for (const DepthPoint& p : points) {
+        out << p.shape << "," << p.restingOrders << "," << p.result.name << "," << p.result.operations << ","
+            << p.result.meanNs << "," << p.result.p50Ns << "," << p.result.p99Ns << ","
+            << p.result.p999Ns << "," << p.result.maxNs << "\n";
+    }
+}
+
+DepthOptions parseOptions(int argc, char** argv) {
+    DepthOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--min-exp") options.minExponent = stoi(argv[i + 1]);
+        else if (flag == "--max-exp") options.maxExponent = stoi(argv[i + 1]);
+        else if (flag == "--samples") options.samples = stoul(argv[i + 1]);
+        else if (flag == "--json") options.jsonPath = argv[i + 1];
+        else if (flag == "--csv") options.csvPath = argv[i + 1];
+        else if (flag == "--label") options.label = argv[i + 1];
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    DepthOptions options = parseOptions(argc, argv);
+    vector<BookShape> shapes = {
+        {"dense_q1", 1, 1},
+        {"dense_q10", 10, 1},
+        {"dense_q100", 100, 1},
+        {"sparse_q1", 1, 10},
+        {"sparse_q10", 10, 10},
+    };
+
+    cout << "Depth sweep 1e" << options.minExponent << "..1e" << options.maxExponent
+         << " resting orders, " << options.samples << " samples per point" << endl;
+
+    vector<DepthPoint> points;
+    for (const BookShape& shape : shapes) {
+        // Collected per operation so each chart row is one curve.
+        vector<vector<DepthPoint>> curves;
+        for (int e = options.minExponent; e <= options.maxExponent; ++e) {
+            size_t resting = static_cast<size_t>(pow(10, e));
+            if (resting < 2 * shape.ordersPerLevel) continue;
+            DepthBench bench(shape, resting);
+            vector<BenchmarkResult> results = {
+                bench.insertAtTouch(options.samples),
+                bench.insertDeep(options.samples),
+                bench.cancelRandom(options.samples),
+                bench.cancelFront(options.samples),
+                bench.sweep(options.samples / 10, 5),
+                bench.fillEstimate(options.samples, false),
+                bench.fillEstimate(options.samples, true),
+                bench.depthSnapshot(options.samples / 10),
+            };
+            curves.resize(results.size());
+            for (size_t op = 0; op < results.size(); ++op) {
+                curves[op].push_back({shape.name, resting, results[op]});
+            }
+            cout << "  " << shape.name << " 1e" << e << " done" << endl;
+        }
+        for (const auto& curve : curves) {
+            points.insert(points.end(), curve.begin(), curve.end());
+        }
+    }
+
+    printChart(points, options);
+    printMemory(shapes, options);
+    writeCsv(options.csvPath, points);
+
+    vector<BenchmarkResult> flat;
+    for (const DepthPoint& p : points) {
+        BenchmarkResult named = p.result;
+        named.name = p.shape + "/" + to_string(p.restingOrders) + "/" + p.result.name;
+        flat.push_back(named);
+    }
+    writeResultsJson(options.jsonPath, options.label, flat);
+    cout << "Results written to " << options.csvPath << " and " << options.jsonPath << endl;
+    return 0;
+}
@@ -1,5 +1,10 @@
 #include "gtest/gtest.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <thread>
 #include "OrderTypes.h"
 #include "Orderbook.h"
 #include "Order.h"
@@ -8,6 +13,19 @@
 #include "CSVParse.h"
 #include "Portfolio.h"
 #include "TradingEngine.h"
+#include "OrderJson.h"
+#include "MappedCSVParse.h"
+#include "BinaryOrderFile.h"
+#include "BinaryProtocol.h"
+#include "DepthLadder.h"
+#include "WorkloadGenerator.h"
+#include "LatencyProbe.h"
+#include "MemoryResources.h"
+#include "TickBitmap.h"
+#include "TopOfBook.h"
+#include "DepthSnapshot.h"
+#include "OrderbookCApi.h"
+#include "RiskGate.h"
 
 TEST(BasicTests, Multiplication) {
     int one = 1;
@@ -313,6 +331,1165 @@ TEST(OrderbookTests, MidPriceEmptyOrderbook) {
     EXPECT_EQ(book.getMidPrice(), Price());
 }
 
+// Test that partial fills and in-place reductions keep the hot queue record
+// and the full order view in step
+TEST(OrderbookTests, RestingOrderViewsStayInStep) {
+    Orderbook book;
+    LimitOrder resting(1, 10, 100, OrderSide::SELL);
+    book.addOrder(resting);
+    LimitOrder taker(2, 4, 100, OrderSide::BUY);
+    book.addOrder(taker);
+
+    const Order* view = book.getOrder(1);
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->getQuantity(), 6);
+    EXPECT_EQ(view->getFilledQuantity(), 4);
+    EXPECT_EQ(view->getStatus(), OrderStatus::PARTIALLY_FILLED);
+    EXPECT_EQ(book.getAsks().begin()->second.front().getQuantity(), 6);
+
+    EXPECT_FALSE(book.reduceOrder(1, 7));
+    EXPECT_TRUE(book.reduceOrder(1, 3));
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 3);
+    EXPECT_EQ(book.getSellInterest(), 3);
+}
+
+// Test that an amend reduces in place, and otherwise replaces the order under
+// its owner at the back of the new level
+TEST(OrderbookTests, AmendReducesInPlaceOrReplaces) {
+    Orderbook book;
+    LimitOrder first(1, 10, 100, OrderSide::SELL);
+    LimitOrder second(2, 10, 100, OrderSide::SELL);
+    book.addOrder(first, 7);
+    book.addOrder(second);
+
+    EXPECT_TRUE(book.amendOrder(1, 4, 100).empty());
+    EXPECT_EQ(book.getAsks().begin()->second.front().orderId, 1u);
+    EXPECT_EQ(book.getSellInterest(), 14);
+
+    // Growing loses priority; the owner stays.
+    EXPECT_TRUE(book.amendOrder(1, 6, 100).empty());
+    EXPECT_EQ(book.getAsks().begin()->second.front().orderId, 2u);
+    EXPECT_EQ(book.ownerOrderCount(7), 1u);
+
+    // A new price that crosses trades as the replacement.
+    LimitOrder bid(3, 5, 99, OrderSide::BUY);
+    book.addOrder(bid);
+    TradeList trades = book.amendOrder(1, 6, 99);
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].getSellOrder().orderID, 1u);
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 1);
+    EXPECT_TRUE(book.amendOrder(42, 5, 100).empty());
+    EXPECT_TRUE(book.amendOrder(1, 0, 100).empty());
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 1);
+}
+
+// Test that a market order sweeping whole levels fills every resting order in
+// time priority and leaves the partially consumed level's total exact
+TEST(OrderbookTests, SweepConsumesWholeLevels) {
+    Orderbook book;
+    OrderID id = 1;
+    for (int level = 1; level <= 3; ++level) {
+        for (int k = 0; k < 2; ++k) {
+            LimitOrder order(id++, 5, 100 + level, OrderSide::SELL);
+            book.addOrder(order);
+        }
+    }
+
+    MarketOrder sweep(100, 23, OrderSide::BUY);
+    TradeList trades = book.addOrder(sweep);
+
+    ASSERT_EQ(trades.size(), 5);
+    for (size_t i = 0; i < trades.size(); ++i) {
+        EXPECT_EQ(trades[i].getSellOrder().orderID, i + 1);
+        EXPECT_EQ(trades[i].getBuyOrder().orderID, 100);
+    }
+    EXPECT_EQ(trades[4].getTradedQuantity(), 3);
+    EXPECT_EQ(trades[4].getPrice(), 103);
+    EXPECT_EQ(sweep.getStatus(), OrderStatus::FILLED);
+
+    EXPECT_EQ(book.getOrder(1), nullptr);
+    EXPECT_EQ(book.getOrder(4), nullptr);
+    EXPECT_EQ(book.getOrder(5)->getQuantity(), 2);
+    EXPECT_EQ(book.getAsks().size(), 1);
+    EXPECT_EQ(book.getAsks().begin()->second.totalQuantity(), 7);
+    EXPECT_EQ(book.getSellInterest(), 7);
+}
+
+// Test that lazily cancelled orders are skipped by queries and matching and
+// reclaimed by compaction
+TEST(OrderbookTests, LazyCancelLeavesTombstones) {
+    Orderbook book;
+    book.setLazyCancel(true);
+    LimitOrder bestBid(1, 10, 101, OrderSide::BUY);
+    LimitOrder queued(2, 10, 100, OrderSide::BUY);
+    LimitOrder front(3, 10, 100, OrderSide::BUY);
+    book.addOrder(bestBid);
+    book.addOrder(front);
+    book.addOrder(queued);
+
+    OrderID id = 1;
+    EXPECT_TRUE(book.cancelOrder(id));
+    EXPECT_FALSE(book.cancelOrder(id));
+    EXPECT_EQ(book.getOrder(1), nullptr);
+    EXPECT_EQ(book.tombstoneCount(), 1);
+    EXPECT_EQ(book.getHighestBid(), 100);
+    EXPECT_EQ(book.getBidInterest(), 20);
+
+    id = 3;
+    book.cancelOrder(id);
+    LimitOrder seller(4, 5, 99, OrderSide::SELL);
+    TradeList trades = book.addOrder(seller);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].getBuyOrder().orderID, 2);
+    EXPECT_EQ(trades[0].getPrice(), 100);
+    EXPECT_EQ(book.tombstoneCount(), 0);
+    EXPECT_EQ(book.getBids().size(), 1);
+}
+
+// Test that an order reusing a live order's ID is rejected without touching
+// the book, while a cancelled order's ID can be reused
+TEST(OrderbookTests, RejectsDuplicateLiveOrderId) {
+    Orderbook book;
+    LimitOrder first(1, 10, 100, OrderSide::SELL);
+    LimitOrder duplicate(1, 10, 100, OrderSide::SELL);
+    book.addOrder(first);
+    EXPECT_TRUE(book.hasLiveOrder(1));
+    EXPECT_TRUE(book.addOrder(duplicate).empty());
+    EXPECT_EQ(duplicate.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(book.getSellInterest(), 10);
+
+    for (OrderID id = 2; id <= 4; ++id) {
+        LimitOrder buy(id, 5, 100, OrderSide::BUY);
+        book.addOrder(buy);
+    }
+    EXPECT_FALSE(book.hasLiveOrder(1));
+    EXPECT_EQ(book.getBidInterest(), 5);
+
+    LimitOrder reused(1, 5, 100, OrderSide::SELL);
+    EXPECT_EQ(book.addOrder(reused).size(), 1u);
+    EXPECT_EQ(book.getBidInterest(), 0);
+}
+
+// Test that budgeted compaction reaches tombstones queued behind more live
+// orders than one step visits
+TEST(OrderbookTests, CompactionResumesPastLiveOrders) {
+    Orderbook book;
+    book.setLazyCancel(true);
+    for (OrderID id = 1; id <= 110; ++id) {
+        LimitOrder ask(id, 10, 100, OrderSide::SELL);
+        book.addOrder(ask);
+    }
+    for (OrderID id = 101; id <= 110; ++id) {
+        OrderID cancel = id;
+        ASSERT_TRUE(book.cancelOrder(cancel));
+    }
+    EXPECT_EQ(book.tombstoneCount(), 10);
+
+    EXPECT_EQ(book.compact(64), 0);
+    EXPECT_EQ(book.compact(64), 10);
+    EXPECT_EQ(book.tombstoneCount(), 0);
+    EXPECT_EQ(book.getAsks().begin()->second.size(), 100);
+
+    // Orders killed behind the resume point are picked up by wrapping round.
+    OrderID cancel = 100;
+    book.cancelOrder(cancel);
+    EXPECT_EQ(book.compact(64), 0);
+    cancel = 1;
+    book.cancelOrder(cancel);
+    EXPECT_EQ(book.compact(64), 2);
+    EXPECT_EQ(book.tombstoneCount(), 0);
+    EXPECT_EQ(book.getAsks().begin()->second.size(), 98);
+}
+
+// Test that lazy and eager cancellation produce identical trades and books
+TEST(OrderbookTests, LazyCancelMatchesEagerCancel) {
+    WorkloadGenerator generator;
+    std::vector<OrderCommand> commands = generator.generate(20000);
+
+    Orderbook eager;
+    Orderbook lazy;
+    lazy.setLazyCancel(true);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        OrderCommand eagerCommand = commands[i];
+        OrderCommand lazyCommand = commands[i];
+        TradeList eagerTrades = applyCommand(eager, eagerCommand);
+        TradeList lazyTrades = applyCommand(lazy, lazyCommand);
+        ASSERT_EQ(eagerTrades.size(), lazyTrades.size()) << "command " << i;
+        for (size_t t = 0; t < eagerTrades.size(); ++t) {
+            EXPECT_EQ(eagerTrades[t].getBuyOrder().orderID, lazyTrades[t].getBuyOrder().orderID);
+            EXPECT_EQ(eagerTrades[t].getSellOrder().orderID, lazyTrades[t].getSellOrder().orderID);
+            EXPECT_EQ(eagerTrades[t].getTradedQuantity(), lazyTrades[t].getTradedQuantity());
+        }
+        if (i % 1000 == 0) {
+            EXPECT_EQ(eager.getHighestBid(), lazy.getHighestBid());
+            EXPECT_EQ(eager.getLowestAsk(), lazy.getLowestAsk());
+        }
+    }
+    EXPECT_EQ(eager.getBidInterest(), lazy.getBidInterest());
+    EXPECT_EQ(eager.getSellInterest(), lazy.getSellInterest());
+
+    lazy.compact();
+    EXPECT_EQ(lazy.tombstoneCount(), 0);
+    EXPECT_EQ(lazy.getBids().size(), eager.getBids().size());
+    EXPECT_EQ(lazy.getAsks().size(), eager.getAsks().size());
+}
+
+// Test that indexed depth queries agree with walking the levels
+TEST(OrderbookTests, DepthIndexMatchesLevelWalk) {
+    WorkloadGenerator generator;
+    std::vector<OrderCommand> commands = generator.generate(20000);
+
+    Orderbook walked;
+    Orderbook indexed;
+    indexed.setLazyCancel(true);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (i == 5000) {
+            indexed.enableDepthIndex(generator.config().tickSize);
+        }
+        OrderCommand walkedCommand = commands[i];
+        OrderCommand indexedCommand = commands[i];
+        applyCommand(walked, walkedCommand);
+        applyCommand(indexed, indexedCommand);
+        if (i < 5000 || i % 250 != 0 || walked.getAsks().empty() || walked.getBids().empty()) {
+            continue;
+        }
+
+        // Limits taken from resting levels so both sides see the same double.
+        Price askLimit = std::next(walked.getAsks().begin(), walked.getAsks().size() / 2)->first;
+        Price bidLimit = std::next(walked.getBids().begin(), walked.getBids().size() / 2)->first;
+        EXPECT_EQ(indexed.askDepthThrough(askLimit), walked.askDepthThrough(askLimit)) << "command " << i;
+        EXPECT_EQ(indexed.bidDepthThrough(bidLimit), walked.bidDepthThrough(bidLimit)) << "command " << i;
+        EXPECT_EQ(indexed.askDepthThrough(walked.getHighestBid()), 0);
+        EXPECT_EQ(indexed.getHighestBid(), walked.getHighestBid());
+        EXPECT_EQ(indexed.getLowestAsk(), walked.getLowestAsk());
+
+        for (Quantity quantity : {Quantity(1), Quantity(500), Quantity(1000000)}) {
+            FillEstimate expected = walked.estimateBuy(quantity);
+            FillEstimate actual = indexed.estimateBuy(quantity);
+            EXPECT_EQ(actual.fillable, expected.fillable);
+            EXPECT_NEAR(actual.cost, expected.cost, 1e-6 * expected.cost);
+            EXPECT_NEAR(actual.worstPrice, expected.worstPrice, 1e-9);
+            expected = walked.estimateSell(quantity);
+            actual = indexed.estimateSell(quantity);
+            EXPECT_EQ(actual.fillable, expected.fillable);
+            EXPECT_NEAR(actual.averagePrice, expected.averagePrice, 1e-6 * expected.averagePrice);
+            EXPECT_NEAR(actual.worstPrice, expected.worstPrice, 1e-9);
+        }
+    }
+    EXPECT_EQ(indexed.estimateBuy(1000000).fillable, walked.getSellInterest());
+}
+
+// Test that the depth index stops growing at its cap and the book answers
+// from the levels while an order rests beyond it
+TEST(OrderbookTests, DepthIndexFallsBackBeyondItsRange) {
+    DepthLadder ladder(0.01, false);
+    ladder.add(100.0, 10);
+    ladder.add(1.0e9, 5);
+    EXPECT_FALSE(ladder.complete());
+    EXPECT_EQ(ladder.totalQuantity(), 10);
+    ladder.add(1.0e9, -5);
+    EXPECT_TRUE(ladder.complete());
+
+    Orderbook book;
+    book.enableDepthIndex(0.01);
+    LimitOrder near(1, 10, 100.0, OrderSide::SELL);
+    LimitOrder far(2, 5, 1.0e9, OrderSide::SELL);
+    LimitOrder cheap(3, 7, 50.0, OrderSide::SELL);
+    book.addOrder(near);
+    book.addOrder(far);
+    book.addOrder(cheap);
+    EXPECT_EQ(book.askDepthThrough(2.0e9), 22);
+    EXPECT_EQ(book.estimateBuy(100).fillable, 22);
+    EXPECT_DOUBLE_EQ(book.estimateBuy(100).worstPrice, 1.0e9);
+    EXPECT_EQ(book.getLowestAsk(), 50.0);
+
+    OrderID farId = 2;
+    book.cancelOrder(farId);
+    EXPECT_EQ(book.askDepthThrough(2.0e9), 17);
+    EXPECT_DOUBLE_EQ(book.estimateBuy(10).worstPrice, 100.0);
+}
+
+// Test that an auction collects crossing orders and uncrosses at one price
+TEST(OrderbookTests, AuctionUncrossMaximizesVolume) {
+    Orderbook book;
+    book.beginAuction();
+    LimitOrder buy1(1, 10, 101, OrderSide::BUY);
+    LimitOrder buy2(2, 20, 100, OrderSide::BUY);
+    LimitOrder buy3(3, 10, 99, OrderSide::BUY);
+    LimitOrder sell1(4, 15, 98, OrderSide::SELL);
+    LimitOrder sell2(5, 10, 100, OrderSide::SELL);
+    LimitOrder sell3(6, 20, 102, OrderSide::SELL);
+    MarketOrder market(7, 5, OrderSide::BUY);
+    for (Order* order : std::vector<Order*>{&buy1, &buy2, &buy3, &sell1, &sell2, &sell3}) {
+        EXPECT_TRUE(book.addOrder(*order).empty());
+    }
+    EXPECT_TRUE(book.addOrder(market).empty());
+    EXPECT_EQ(market.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_GT(book.getHighestBid(), book.getLowestAsk());
+
+    AuctionResult result = book.uncross(100);
+    EXPECT_FALSE(book.inAuction());
+    EXPECT_EQ(result.price, 100);
+    EXPECT_EQ(result.volume, 25);
+    EXPECT_EQ(result.imbalance, 5);
+    ASSERT_EQ(result.trades.size(), 3);
+    Quantity traded = 0;
+    for (const Trade& trade : result.trades) {
+        EXPECT_EQ(trade.getPrice(), 100);
+        traded += trade.getTradedQuantity();
+    }
+    EXPECT_EQ(traded, 25);
+    EXPECT_EQ(result.trades[0].getBuyOrder().orderID, 1);
+    EXPECT_EQ(result.trades[0].getSellOrder().orderID, 4);
+
+    EXPECT_EQ(book.getHighestBid(), 100);
+    EXPECT_EQ(book.getLowestAsk(), 102);
+    EXPECT_EQ(book.getOrder(2)->getQuantity(), 5);
+    EXPECT_EQ(book.getOrder(1), nullptr);
+}
+
+// Test the imbalance, market pressure and reference price tie-breaks
+TEST(OrderbookTests, AuctionTieBreaks) {
+    Orderbook balanced;
+    balanced.beginAuction();
+    LimitOrder buy(1, 10, 101, OrderSide::BUY);
+    LimitOrder sell(2, 10, 100, OrderSide::SELL);
+    balanced.addOrder(buy);
+    balanced.addOrder(sell);
+    EXPECT_EQ(balanced.indicativeUncross(100.2).price, 100);
+    EXPECT_EQ(balanced.indicativeUncross(100.8).price, 101);
+
+    Orderbook buyPressure;
+    buyPressure.beginAuction();
+    LimitOrder bigBuy(1, 20, 101, OrderSide::BUY);
+    LimitOrder smallSell(2, 10, 100, OrderSide::SELL);
+    buyPressure.addOrder(bigBuy);
+    buyPressure.addOrder(smallSell);
+    AuctionResult result = buyPressure.indicativeUncross(100);
+    EXPECT_EQ(result.price, 101);
+    EXPECT_EQ(result.imbalance, 10);
+    EXPECT_TRUE(buyPressure.inAuction());
+
+    Orderbook uncrossed;
+    uncrossed.beginAuction();
+    LimitOrder lowBuy(1, 10, 99, OrderSide::BUY);
+    LimitOrder highSell(2, 10, 100, OrderSide::SELL);
+    uncrossed.addOrder(lowBuy);
+    uncrossed.addOrder(highSell);
+    EXPECT_EQ(uncrossed.uncross(100).volume, 0);
+    EXPECT_EQ(uncrossed.getBids().size(), 1);
+}
+
+// Test that a full batch clears at one price against the resting book
+TEST(OrderbookTests, BatchModeClearsAtUniformPrice) {
+    Orderbook book;
+    LimitOrder resting(1, 10, 101, OrderSide::SELL);
+    book.addOrder(resting);
+
+    book.setBatchMode(BatchConfig{3, 0});
+    LimitOrder buy1(2, 5, 102, OrderSide::BUY);
+    LimitOrder sell(3, 5, 100, OrderSide::SELL);
+    LimitOrder buy2(4, 10, 101, OrderSide::BUY);
+    EXPECT_TRUE(book.addOrder(buy1).empty());
+    EXPECT_TRUE(book.addOrder(sell).empty());
+    EXPECT_EQ(book.pendingBatchSize(), 2);
+    EXPECT_EQ(book.getOrder(2), nullptr);
+
+    TradeList trades = book.addOrder(buy2);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].getBuyOrder().orderID, 2);
+    EXPECT_EQ(trades[0].getSellOrder().orderID, 3);
+    EXPECT_EQ(trades[1].getBuyOrder().orderID, 4);
+    EXPECT_EQ(trades[1].getSellOrder().orderID, 1);
+    for (const Trade& trade : trades) {
+        EXPECT_EQ(trade.getPrice(), 101);
+    }
+    EXPECT_EQ(book.pendingBatchSize(), 0);
+    EXPECT_TRUE(book.getBids().empty());
+    EXPECT_TRUE(book.getAsks().empty());
+}
+
+// Test the batch clock, cancels of queued orders and IOC leftovers
+TEST(OrderbookTests, BatchModeIntervalAndCancels) {
+    Orderbook book;
+    book.setBatchMode(BatchConfig{0, 1000});
+    EXPECT_TRUE(book.advanceClock(100).empty());
+
+    Order ioc(1, 5, 100, OrderType::LIMIT, OrderSide::BUY, DurationType::IMMEDIATE_OR_CANCEL);
+    LimitOrder gtc(2, 5, 99, OrderSide::BUY);
+    LimitOrder cancelled(3, 5, 98, OrderSide::BUY);
+    MarketOrder market(4, 5, OrderSide::SELL);
+    book.addOrder(ioc);
+    book.addOrder(gtc);
+    book.addOrder(cancelled);
+    book.addOrder(market);
+    EXPECT_EQ(market.getStatus(), OrderStatus::CANCELLED);
+    OrderID cancelId = 3;
+    EXPECT_TRUE(book.cancelOrder(cancelId));
+    EXPECT_EQ(book.pendingBatchSize(), 2);
+
+    book.advanceClock(999);
+    EXPECT_EQ(book.pendingBatchSize(), 2);
+    book.advanceClock(1000);
+    EXPECT_EQ(book.pendingBatchSize(), 0);
+    EXPECT_EQ(book.getOrder(1), nullptr);
+    ASSERT_NE(book.getOrder(2), nullptr);
+    EXPECT_EQ(book.getBids().size(), 1);
+}
+
+// Test that changing the batch mode clears the open batch instead of stranding it
+TEST(OrderbookTests, BatchModeChangeClearsOpenBatch) {
+    Orderbook book;
+    book.setBatchMode(BatchConfig{10, 0});
+    LimitOrder buy(1, 5, 101, OrderSide::BUY);
+    LimitOrder sell(2, 3, 100, OrderSide::SELL);
+    LimitOrder bid(3, 4, 99, OrderSide::BUY);
+    book.addOrder(buy);
+    book.addOrder(sell);
+    book.addOrder(bid);
+    EXPECT_EQ(book.pendingBatchSize(), 3);
+
+    TradeList trades = book.setBatchMode(BatchConfig{});
+    EXPECT_FALSE(book.batching());
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].getTradedQuantity(), 3);
+    EXPECT_EQ(book.pendingBatchSize(), 0);
+    ASSERT_NE(book.getOrder(1), nullptr);
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 2);
+    EXPECT_EQ(book.getBidInterest(), 6);
+
+    // Not batching any more: the next order matches on arrival.
+    LimitOrder taker(4, 2, 101, OrderSide::SELL);
+    EXPECT_EQ(book.addOrder(taker).size(), 1);
+}
+
+// Test that mass cancels by owner, owner and side, and price level remove exactly their orders
+TEST(OrderbookTests, MassCancelByOwnerSideAndLevel) {
+    Orderbook book;
+    const OwnerID alice = 1;
+    const OwnerID bob = 2;
+    for (OrderID id = 1; id <= 6; ++id) {
+        LimitOrder bid(id, 10, 99.0 - static_cast<double>(id % 3), OrderSide::BUY);
+        book.addOrder(bid, id % 2 ? alice : bob);
+    }
+    for (OrderID id = 7; id <= 9; ++id) {
+        LimitOrder ask(id, 10, 101.0, OrderSide::SELL);
+        book.addOrder(ask, alice);
+    }
+    LimitOrder anonymous(10, 10, 99.0, OrderSide::BUY);
+    book.addOrder(anonymous);
+    EXPECT_EQ(book.ownerOrderCount(alice), 6u);
+    EXPECT_EQ(book.ownerOrderCount(bob), 3u);
+    EXPECT_EQ(book.getOwner(2), bob);
+    EXPECT_EQ(book.getOwner(10), NO_OWNER);
+    EXPECT_EQ(book.getOwner(42), NO_OWNER);
+
+    // A fill takes the order out of its owner's list.
+    MarketOrder taker(11, 10, OrderSide::BUY);
+    book.addOrder(taker);
+    EXPECT_EQ(book.ownerOrderCount(alice), 5u);
+
+    EXPECT_EQ(book.cancelOwner(alice, OrderSide::SELL), 2u);
+    EXPECT_TRUE(book.getAsks().empty());
+    EXPECT_EQ(book.getOwner(8), NO_OWNER);
+    EXPECT_EQ(book.cancelOwner(alice), 3u);
+    EXPECT_EQ(book.ownerOrderCount(alice), 0u);
+    EXPECT_EQ(book.cancelOwner(alice), 0u);
+    EXPECT_EQ(book.getBidInterest(), 40);
+
+    // 99.0 now holds bob's order 6 and the ownerless order 10.
+    EXPECT_EQ(book.cancelLevel(OrderSide::BUY, 99.0), 2u);
+    EXPECT_EQ(book.getOrder(10), nullptr);
+    EXPECT_EQ(book.ownerOrderCount(bob), 2u);
+    EXPECT_EQ(book.cancelOwner(bob), 2u);
+    EXPECT_TRUE(book.getBids().empty());
+    EXPECT_EQ(book.memoryStats().restingOrders, 0u);
+}
+
+// Test that owner cancels leave tombstones under lazy cancel and survive ID reuse
+TEST(OrderbookTests, OwnerCancelWithLazyCancelAndIdReuse) {
+    Orderbook book;
+    book.setLazyCancel(true);
+    for (OrderID id = 1; id <= 4; ++id) {
+        LimitOrder bid(id, 5, 100.0, OrderSide::BUY);
+        book.addOrder(bid, 7);
+    }
+    EXPECT_EQ(book.cancelOwner(7), 4u);
+    EXPECT_EQ(book.tombstoneCount(), 4u);
+    EXPECT_EQ(book.getHighestBid(), 0.0);
+
+    // Reusing an ID while its tombstone is still queued.
+    LimitOrder reused(2, 5, 100.0, OrderSide::BUY);
+    book.addOrder(reused, 8);
+    EXPECT_EQ(book.ownerOrderCount(7), 0u);
+    EXPECT_EQ(book.ownerOrderCount(8), 1u);
+    EXPECT_EQ(book.cancelLevel(OrderSide::BUY, 100.0), 1u);
+    EXPECT_EQ(book.tombstoneCount(), 0u);
+    EXPECT_EQ(book.ownerOrderCount(8), 0u);
+    EXPECT_TRUE(book.getBids().empty());
+}
+
+// Test that memory accounting tracks levels and orders and keeps its peak
+TEST(OrderbookTests, MemoryStatsTrackRestingOrders) {
+    Orderbook book;
+    LimitOrder buyOrder1(1, 10, 99, OrderSide::BUY);
+    LimitOrder buyOrder2(2, 10, 99, OrderSide::BUY);
+    LimitOrder sellOrder(3, 10, 101, OrderSide::SELL);
+    book.addOrder(buyOrder1);
+    book.addOrder(buyOrder2);
+    book.addOrder(sellOrder);
+
+    BookMemoryStats stats = book.memoryStats();
+    EXPECT_EQ(stats.restingOrders, 3);
+    EXPECT_EQ(stats.bidLevels.elements, 1);
+    EXPECT_EQ(stats.askLevels.elements, 1);
+    EXPECT_EQ(stats.levelQueues.elements, 3);
+    EXPECT_GE(stats.totalBytesReserved, stats.totalBytesUsed);
+    EXPECT_GT(stats.bytesPerOrder, sizeof(Order));
+
+    OrderID id = 3;
+    book.cancelOrder(id);
+    BookMemoryStats after = book.memoryStats();
+    EXPECT_EQ(after.askLevels.elements, 0);
+    EXPECT_LT(after.totalBytesReserved, stats.totalBytesReserved);
+    EXPECT_EQ(after.highWaterBytes, stats.highWaterBytes);
+}
+
+// Test that a pooled book allocates from its own resource and reuses freed nodes
+TEST(OrderbookTests, PooledBookReusesNodes) {
+    BookPool pool;
+    Orderbook book(pool.resource());
+    EXPECT_EQ(book.resource(), pool.resource());
+
+    for (OrderID id = 1; id <= 100; ++id) {
+        LimitOrder order(id, 10, 90.0 + id % 10, OrderSide::BUY);
+        book.addOrder(order);
+    }
+    std::size_t peak = pool.highWaterBytes();
+    EXPECT_GT(peak, 100 * sizeof(Order));
+
+    for (OrderID id = 1; id <= 100; ++id) {
+        OrderID cancelID = id;
+        book.cancelOrder(cancelID);
+    }
+    EXPECT_LT(pool.bytesInUse(), peak);
+
+    for (OrderID id = 101; id <= 200; ++id) {
+        LimitOrder order(id, 10, 90.0 + id % 10, OrderSide::BUY);
+        book.addOrder(order);
+    }
+    EXPECT_EQ(pool.highWaterBytes(), peak);
+    EXPECT_EQ(book.getBidInterest(), 1000);
+}
+
+// Test that set ticks are found across long runs of empty words
+TEST(TickBitmapTests, FindsAcrossWideGaps) {
+    TickBitmap bitmap(200000);
+    EXPECT_TRUE(bitmap.none());
+    EXPECT_EQ(bitmap.findFirst(), TickBitmap::npos);
+
+    bitmap.set(199999);
+    bitmap.set(70000);
+    bitmap.set(5);
+    EXPECT_FALSE(bitmap.none());
+    EXPECT_EQ(bitmap.findFirst(), 5);
+    EXPECT_EQ(bitmap.findNext(6), 70000);
+    EXPECT_EQ(bitmap.findNext(70001), 199999);
+    EXPECT_EQ(bitmap.findNext(200000), TickBitmap::npos);
+
+    bitmap.reset(5);
+    bitmap.reset(70000);
+    EXPECT_EQ(bitmap.findFirst(), 199999);
+    EXPECT_TRUE(bitmap.test(199999));
+    bitmap.reset(199999);
+    EXPECT_TRUE(bitmap.none());
+}
+
+// Test that the published top of book skips dead levels and keeps the last trade
+TEST(TopOfBookTests, PublishesLiveLevelsAndLastTrade) {
+    Orderbook book;
+    book.setLazyCancel(true);
+    for (OrderID id = 1; id <= 7; ++id) {
+        LimitOrder bid(id, 10 * id, 100.0 - id, OrderSide::BUY);
+        book.addOrder(bid);
+    }
+    LimitOrder ask(20, 50, 101.0, OrderSide::SELL);
+    book.addOrder(ask);
+    OrderID best = 1;
+    book.cancelOrder(best);
+
+    TopOfBookPublisher feed;
+    EXPECT_EQ(feed.read().sequence, 0u);
+    TopOfBook top = book.topOfBook();
+    top.lastTradePrice = 100.5;
+    top.lastTradeQuantity = 3;
+    feed.publish(top);
+    feed.publish(book.topOfBook());
+
+    TopOfBook read = feed.read();
+    EXPECT_EQ(read.sequence, 2u);
+    ASSERT_EQ(read.bidCount, TopOfBook::DEPTH);
+    EXPECT_EQ(read.bids[0].price, 98.0);
+    EXPECT_EQ(read.bids[0].quantity, 20);
+    EXPECT_EQ(read.bids[4].price, 94.0);
+    ASSERT_EQ(read.askCount, 1u);
+    EXPECT_EQ(read.asks[0].quantity, 50);
+    EXPECT_EQ(read.midPrice(), 99.5);
+    EXPECT_EQ(read.lastTradePrice, 100.5);
+    EXPECT_EQ(read.lastTradeQuantity, 3);
+}
+
+// Test that concurrent readers never see a torn top of book
+TEST(TopOfBookTests, ConcurrentReadersSeeWholeSnapshots) {
+    TopOfBookPublisher feed;
+    const std::uint64_t publishes = 200000;
+    std::atomic<bool> done{false};
+
+    // Every field of snapshot n is derived from n, so a torn read shows up
+    // as fields that disagree with each other.
+    auto reader = [&](bool& consistent) {
+        std::uint64_t lastSeen = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            TopOfBook top = feed.read();
+            if (top.sequence == 0) {
+                continue;
+            }
+            Quantity n = static_cast<Quantity>(top.sequence);
+            for (std::size_t i = 0; i < TopOfBook::DEPTH; ++i) {
+                consistent &= top.bids[i].quantity == n + Quantity(i) && top.asks[i].quantity == n - Quantity(i);
+            }
+            consistent &= top.lastTradeQuantity == n && top.bidCount == (n % 5) + 1;
+            consistent &= top.sequence >= lastSeen;
+            lastSeen = top.sequence;
+        }
+    };
+    bool consistent[2] = {true, true};
+    std::thread first(reader, std::ref(consistent[0]));
+    std::thread second(reader, std::ref(consistent[1]));
+
+    for (std::uint64_t seq = 1; seq <= publishes; ++seq) {
+        Quantity n = static_cast<Quantity>(seq);
+        TopOfBook top;
+        top.bidCount = static_cast<std::uint32_t>(n % 5) + 1;
+        for (std::size_t i = 0; i < TopOfBook::DEPTH; ++i) {
+            top.bids[i] = BookLevel{100.0 - i, n + Quantity(i)};
+            top.asks[i] = BookLevel{101.0 + i, n - Quantity(i)};
+        }
+        top.lastTradePrice = 100.5;
+        top.lastTradeQuantity = n;
+        feed.publish(top);
+    }
+    done.store(true, std::memory_order_release);
+    first.join();
+    second.join();
+
+    EXPECT_TRUE(consistent[0]);
+    EXPECT_TRUE(consistent[1]);
+    EXPECT_EQ(feed.read().sequence, publishes);
+}
+
+// Test that snapshots share unchanged sides and stay valid after later publishes
+TEST(DepthSnapshotTests, SharesUnchangedSidesAndOutlivesPublishes) {
+    Orderbook book;
+    DepthSnapshotPublisher feed;
+    EXPECT_EQ(feed.acquire(), nullptr);
+
+    LimitOrder bid(1, 10, 99.0, OrderSide::BUY);
+    LimitOrder ask(2, 20, 101.0, OrderSide::SELL);
+    book.addOrder(bid);
+    book.addOrder(ask);
+    ASSERT_TRUE(feed.publish(book));
+    EXPECT_FALSE(feed.publish(book));
+    DepthSnapshotPublisher::Snapshot first = feed.acquire();
+    ASSERT_EQ(first->bids->size(), 1u);
+    EXPECT_EQ((*first->asks)[0].quantity, 20);
+
+    LimitOrder secondAsk(3, 5, 100.5, OrderSide::SELL);
+    book.addOrder(secondAsk);
+    ASSERT_TRUE(feed.publish(book));
+    DepthSnapshotPublisher::Snapshot second = feed.acquire();
+    EXPECT_EQ(second->sequence, 2u);
+    EXPECT_EQ(second->bids, first->bids);
+    ASSERT_EQ(second->asks->size(), 2u);
+    EXPECT_EQ((*second->asks)[0].price, 100.5);
+
+    OrderID cancelled = 1;
+    book.cancelOrder(cancelled);
+    ASSERT_TRUE(feed.publish(book));
+    EXPECT_TRUE(feed.acquire()->bids->empty());
+    EXPECT_EQ(feed.retiredCount(), 0u);
+    // Earlier views are untouched by later publishes.
+    EXPECT_EQ(first->asks->size(), 1u);
+    EXPECT_EQ(second->bids->size(), 1u);
+}
+
+// Test that snapshots built from the depth journal match ones built from the book
+TEST(DepthSnapshotTests, JournalFedSnapshotsMatchTheBook) {
+    WorkloadGenerator generator;
+    std::vector<OrderCommand> commands = generator.generate(20000);
+    Orderbook book;
+    book.setLazyCancel(true);
+    DepthSnapshotPublisher fromBook;
+    DepthSnapshotPublisher fromJournal;
+    DepthChanges changes(book.resource());
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (i == 3000) {
+            book.enableDepthJournal();
+        }
+        applyCommand(book, commands[i]);
+        if (i < 3000 || i % 500 != 0) {
+            continue;
+        }
+        book.drainDepthChanges(changes);
+        EXPECT_TRUE(fromBook.publish(book));
+        EXPECT_TRUE(fromJournal.publish(changes, book.revision(OrderSide::BUY), book.revision(OrderSide::SELL)));
+        DepthSnapshotPublisher::Snapshot expected = fromBook.acquire();
+        DepthSnapshotPublisher::Snapshot actual = fromJournal.acquire();
+        ASSERT_EQ(actual->bids->size(), expected->bids->size()) << "command " << i;
+        ASSERT_EQ(actual->asks->size(), expected->asks->size()) << "command " << i;
+        for (size_t level = 0; level < expected->bids->size(); ++level) {
+            EXPECT_EQ((*actual->bids)[level].price, (*expected->bids)[level].price);
+            EXPECT_EQ((*actual->bids)[level].quantity, (*expected->bids)[level].quantity);
+        }
+        for (size_t level = 0; level < expected->asks->size(); ++level) {
+            EXPECT_EQ((*actual->asks)[level].price, (*expected->asks)[level].price);
+            EXPECT_EQ((*actual->asks)[level].quantity, (*expected->asks)[level].quantity);
+        }
+    }
+    // A drain with nothing new publishes nothing.
+    book.drainDepthChanges(changes);
+    fromJournal.publish(changes, book.revision(OrderSide::BUY), book.revision(OrderSide::SELL));
+    book.drainDepthChanges(changes);
+    EXPECT_TRUE(changes.empty());
+    EXPECT_FALSE(fromJournal.publish(changes, book.revision(OrderSide::BUY), book.revision(OrderSide::SELL)));
+}
+
+// Test that concurrent readers only ever see complete depth snapshots
+TEST(DepthSnapshotTests, ConcurrentReadersSeeCompleteSnapshots) {
+    Orderbook book;
+    DepthSnapshotPublisher feed;
+    const OrderID orders = 20000;
+    std::atomic<bool> done{false};
+
+    // Order n adds one lot to the bids and the book is published after each,
+    // so snapshot n must show exactly n lots.
+    auto reader = [&](bool& consistent) {
+        std::vector<DepthSnapshotPublisher::Snapshot> held;
+        while (!done.load(std::memory_order_acquire)) {
+            DepthSnapshotPublisher::Snapshot snapshot = feed.acquire();
+            if (!snapshot) {
+                continue;
+            }
+            Quantity lots = 0;
+            for (const BookLevel& level : *snapshot->bids) {
+                lots += level.quantity;
+            }
+            consistent &= lots == static_cast<Quantity>(snapshot->sequence);
+            if (held.size() < 64) {
+                held.push_back(snapshot);
+            }
+        }
+        for (const auto& snapshot : held) {
+            Quantity lots = 0;
+            for (const BookLevel& level : *snapshot->bids) {
+                lots += level.quantity;
+            }
+            consistent &= lots == static_cast<Quantity>(snapshot->sequence);
+        }
+    };
+    bool consistent[2] = {true, true};
+    std::thread first(reader, std::ref(consistent[0]));
+    std::thread second(reader, std::ref(consistent[1]));
+
+    for (OrderID id = 1; id <= orders; ++id) {
+        LimitOrder bid(id, 1, 100.0 - static_cast<double>(id % 50), OrderSide::BUY);
+        book.addOrder(bid);
+        feed.publish(book);
+    }
+    done.store(true, std::memory_order_release);
+    first.join();
+    second.join();
+
+    EXPECT_TRUE(consistent[0]);
+    EXPECT_TRUE(consistent[1]);
+    EXPECT_EQ(feed.acquire()->sequence, orders);
+}
+
+// Test that the C interface submits batches, rejects invalid orders and hands
+// out depth and trade arrays
+TEST(OrderbookCApiTests, SubmitsBatchesAndExposesArrays) {
+    ob_book* book = ob_book_create();
+    ASSERT_NE(book, nullptr);
+
+    auto makeOrder = [](uint64_t id, int64_t quantity, double price, OrderSide side) {
+        ob_order order{};
+        order.order_id = id;
+        order.quantity = quantity;
+        order.price = price;
+        order.side = static_cast<uint8_t>(side);
+        order.type = static_cast<uint8_t>(OrderType::LIMIT);
+        order.duration = static_cast<uint8_t>(DurationType::GOOD_TILL_CANCELLED);
+        return order;
+    };
+    ob_order orders[] = {
+        makeOrder(1, 10, 101.0, OrderSide::SELL),
+        makeOrder(2, 10, 102.0, OrderSide::SELL),
+        makeOrder(3, 5, 99.0, OrderSide::BUY),
+        makeOrder(4, 15, 102.0, OrderSide::BUY),
+        makeOrder(5, 0, 100.0, OrderSide::BUY),
+        makeOrder(2, 5, 103.0, OrderSide::SELL),
+        makeOrder(7, 5, std::numeric_limits<double>::quiet_NaN(), OrderSide::SELL),
+        makeOrder(8, 5, std::numeric_limits<double>::infinity(), OrderSide::SELL),
+    };
+    ob_order_result results[8];
+    EXPECT_EQ(ob_submit_orders(book, orders, 8, results), 2u);
+    EXPECT_EQ(results[3].filled_quantity, 15);
+    EXPECT_EQ(results[3].status, static_cast<uint8_t>(OrderStatus::FILLED));
+    for (int rejected = 4; rejected < 8; ++rejected) {
+        EXPECT_EQ(results[rejected].status, OB_REJECTED);
+    }
+
+    const ob_trade* trades = nullptr;
+    ASSERT_EQ(ob_get_trades(book, &trades), 2u);
+    EXPECT_EQ(trades[0].sell_order_id, 1u);
+    EXPECT_EQ(trades[1].quantity, 5);
+
+    ob_depth depth;
+    ob_get_depth(book, &depth);
+    ASSERT_EQ(depth.bid_count, 1u);
+    ASSERT_EQ(depth.ask_count, 1u);
+    EXPECT_EQ(depth.asks[0].price, 102.0);
+    EXPECT_EQ(depth.asks[0].quantity, 5);
+
+    EXPECT_EQ(ob_cancel_order(book, 3), 1);
+    EXPECT_EQ(ob_cancel_order(book, 3), 0);
+    ob_order owned = makeOrder(6, 1, 90.0, OrderSide::BUY);
+    owned.owner = 42;
+    ob_submit_orders(book, &owned, 1, nullptr);
+    EXPECT_EQ(ob_cancel_owner(book, 42), 1u);
+    ob_depth after;
+    ob_get_depth(book, &after);
+    EXPECT_EQ(after.bid_count, 0u);
+    EXPECT_EQ(after.asks, depth.asks);  // unchanged side is not rebuilt
+
+    ob_clear_trades(book);
+    EXPECT_EQ(ob_get_trades(book, &trades), 0u);
+    ob_book_destroy(book);
+}
+
+// Test that the compact book trades exactly like the default one
+TEST(CompactOrderbookTests, MatchesLikeTheDefaultBook) {
+    Orderbook wide;
+    CompactOrderbook compact;
+    Xoshiro256 rng(7);
+    for (OrderID id = 1; id <= 5000; ++id) {
+        OrderSide side = rng.uniform(2) ? OrderSide::BUY : OrderSide::SELL;
+        Price price = 100.0 + (static_cast<double>(rng.uniform(201)) - 100.0) / 100;
+        Quantity quantity = 1 + static_cast<Quantity>(rng.uniform(50));
+        LimitOrder a(id, quantity, price, side);
+        LimitOrder b(id, quantity, price, side);
+        TradeList wideTrades = wide.addOrder(a);
+        TradeList compactTrades = compact.addOrder(b);
+        ASSERT_EQ(wideTrades.size(), compactTrades.size());
+        for (size_t i = 0; i < wideTrades.size(); ++i) {
+            EXPECT_EQ(wideTrades[i].getPrice(), compactTrades[i].getPrice());
+            EXPECT_EQ(wideTrades[i].getSellOrder().orderID, compactTrades[i].getSellOrder().orderID);
+            EXPECT_EQ(wideTrades[i].getTradedQuantity(), compactTrades[i].getTradedQuantity());
+        }
+        if (id % 7 == 0) {
+            OrderID cancelA = id - 3;
+            OrderID cancelB = id - 3;
+            EXPECT_EQ(wide.cancelOrder(cancelA), compact.cancelOrder(cancelB));
+        }
+    }
+    EXPECT_EQ(wide.getHighestBid(), compact.getHighestBid());
+    EXPECT_EQ(wide.getLowestAsk(), compact.getLowestAsk());
+    EXPECT_EQ(wide.getBidInterest(), compact.getBidInterest());
+    EXPECT_EQ(wide.getAsks().size(), compact.getAsks().size());
+    EXPECT_LT(compact.memoryStats().levelQueues.bytesUsed, wide.memoryStats().levelQueues.bytesUsed);
+}
+
+// Test that the compact book cancels orders that do not fit its types or bounds
+TEST(CompactOrderbookTests, RejectsWhatDoesNotFit) {
+    CompactOrderbook book;
+    LimitOrder offGrid(1, 10, 100.005, OrderSide::BUY);
+    LimitOrder tooLarge(2, Quantity(1) << 40, 100.0, OrderSide::BUY);
+    LimitOrder wideId(OrderID(1) << 33, 10, 100.0, OrderSide::BUY);
+    book.addOrder(offGrid);
+    book.addOrder(tooLarge);
+    book.addOrder(wideId);
+    EXPECT_EQ(offGrid.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(tooLarge.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(wideId.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_TRUE(book.getBids().empty());
+
+    // Fill the ask side to its level bound; a new level is then refused but
+    // an existing one still takes orders, and the bid side is unaffected.
+    OrderID id = 10;
+    for (std::size_t level = 0; level < CompactBookTraits::MAX_LEVELS; ++level) {
+        LimitOrder ask(id++, 1, 100.0 + static_cast<double>(level) / 100, OrderSide::SELL);
+        book.addOrder(ask);
+    }
+    LimitOrder extraLevel(id++, 1, 99.99, OrderSide::SELL);
+    LimitOrder sameLevel(id++, 1, 100.0, OrderSide::SELL);
+    book.addOrder(extraLevel);
+    book.addOrder(sameLevel);
+    EXPECT_EQ(extraLevel.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(sameLevel.getStatus(), OrderStatus::OPEN);
+    EXPECT_EQ(book.getAsks().size(), CompactBookTraits::MAX_LEVELS);
+    EXPECT_EQ(book.getLowestAsk(), 100.0);
+
+    LimitOrder buy(id++, 3, 100.0, OrderSide::BUY);
+    EXPECT_EQ(book.addOrder(buy).size(), 2u);
+    EXPECT_EQ(buy.getStatus(), OrderStatus::PARTIALLY_FILLED);
+    EXPECT_EQ(book.getHighestBid(), 100.0);
+}
+
+// Test that each risk limit rejects an order before it reaches the book
+TEST(RiskGateTests, RejectsEachLimitBeforeTheBook) {
+    Orderbook book;
+    RiskGate gate;
+    RiskLimits limits;
+    limits.maxOrderQuantity = 100;
+    limits.maxOpenNotional = 5000.0;
+    limits.maxPosition = 150;
+    limits.maxOrdersPerSecond = 3;
+    gate.setDefaultLimits(limits);
+    const OwnerID account = 7;
+    const Timestamp oneSecond = 1000000000;
+
+    RiskReject reject = RiskReject::NONE;
+    LimitOrder tooLarge(1, 101, 10.0, OrderSide::BUY);
+    gate.submit(book, tooLarge, account, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::ORDER_QUANTITY);
+    EXPECT_EQ(tooLarge.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_TRUE(book.getBids().empty());
+
+    LimitOrder first(2, 100, 10.0, OrderSide::BUY);
+    gate.submit(book, first, account, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::NONE);
+    EXPECT_EQ(book.ownerOrderCount(account), 1u);
+
+    LimitOrder overPosition(3, 60, 10.0, OrderSide::BUY);
+    LimitOrder overNotional(4, 100, 60.0, OrderSide::SELL);
+    EXPECT_EQ(gate.check(overPosition, account, 0), RiskReject::POSITION);
+    EXPECT_EQ(gate.check(overNotional, account, 0), RiskReject::OPEN_NOTIONAL);
+
+    LimitOrder secondOrder(5, 50, 20.0, OrderSide::SELL);
+    LimitOrder third(6, 10, 20.0, OrderSide::SELL);
+    LimitOrder fourth(7, 10, 20.0, OrderSide::SELL);
+    gate.submit(book, secondOrder, account, 10);
+    gate.submit(book, third, account, 20);
+    EXPECT_EQ(gate.check(fourth, account, 30), RiskReject::ORDER_RATE);
+    EXPECT_EQ(gate.check(fourth, account, oneSecond), RiskReject::NONE);
+    // Another account has its own window and exposure.
+    EXPECT_EQ(gate.check(fourth, account + 1, 30), RiskReject::NONE);
+
+    const RiskExposure* exposure = gate.exposure(account);
+    ASSERT_NE(exposure, nullptr);
+    EXPECT_EQ(exposure->openBuyQuantity, 100);
+    EXPECT_EQ(exposure->openSellQuantity, 60);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 1000.0 + 1200.0);
+
+    // A live ID is refused before it can displace the tracked order.
+    LimitOrder reused(2, 10, 10.0, OrderSide::SELL);
+    gate.submit(book, reused, account + 1, oneSecond, &reject);
+    EXPECT_EQ(reject, RiskReject::DUPLICATE_ORDER_ID);
+    EXPECT_EQ(reused.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(gate.trackedOrderCount(), 3u);
+    EXPECT_EQ(exposure->openBuyQuantity, 100);
+    EXPECT_EQ(gate.exposure(account + 1), nullptr);
+}
+
+// Test that risk exposure follows fills, cancels and account mass cancels
+TEST(RiskGateTests, TracksFillsCancelsAndMassCancel) {
+    Orderbook book;
+    RiskGate gate;
+    RiskLimits limits;
+    limits.maxPosition = 100;
+    gate.setLimits(1, limits);
+
+    LimitOrder bid(1, 80, 10.0, OrderSide::BUY);
+    gate.submit(book, bid, 1, 0);
+    // Someone else's order fills part of it; only the trades tell the gate.
+    LimitOrder hit(100, 30, 10.0, OrderSide::SELL);
+    gate.onTrades(book.addOrder(hit));
+    const RiskExposure* exposure = gate.exposure(1);
+    ASSERT_NE(exposure, nullptr);
+    EXPECT_EQ(exposure->position, 30);
+    EXPECT_EQ(exposure->openBuyQuantity, 50);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 500.0);
+
+    LimitOrder more(2, 70, 9.0, OrderSide::BUY);
+    EXPECT_EQ(gate.check(more, 1, 0), RiskReject::POSITION);
+    OrderID cancelId = 1;
+    book.cancelOrder(cancelId);
+    gate.sync(book, 1);
+    EXPECT_EQ(exposure->openBuyQuantity, 0);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 0.0);
+    gate.submit(book, more, 1, 0);
+    EXPECT_EQ(more.getStatus(), OrderStatus::OPEN);
+
+    // The incoming side of a trade counts too.
+    LimitOrder otherBid(101, 25, 9.5, OrderSide::BUY);
+    gate.onTrades(book.addOrder(otherBid));
+    MarketOrder sell(3, 20, OrderSide::SELL);
+    EXPECT_EQ(gate.submit(book, sell, 1, 0).size(), 1u);
+    EXPECT_EQ(exposure->position, 10);
+    EXPECT_EQ(exposure->openSellQuantity, 0);
+    EXPECT_EQ(gate.trackedOrderCount(), 1u);
+
+    EXPECT_EQ(gate.cancelAccount(book, 1), 1u);
+    EXPECT_EQ(gate.trackedOrderCount(), 0u);
+    EXPECT_EQ(exposure->openBuyQuantity, 0);
+    EXPECT_EQ(exposure->position, 10);
+    EXPECT_EQ(book.getBidInterest(), 5);
+}
+
+// Test that an amend is checked without the exposure it replaces
+TEST(RiskGateTests, ChecksAmendsAgainstTheReplacement) {
+    Orderbook book;
+    RiskGate gate;
+    RiskLimits limits;
+    limits.maxOpenNotional = 1500.0;
+    gate.setLimits(1, limits);
+
+    LimitOrder bid(1, 100, 10.0, OrderSide::BUY);
+    gate.submit(book, bid, 1, 0);
+    const RiskExposure* exposure = gate.exposure(1);
+    RiskReject reject = RiskReject::NONE;
+    gate.amend(book, 1, 140, 10.0, 1, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::NONE);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 1400.0);
+
+    gate.amend(book, 1, 160, 10.0, 1, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::OPEN_NOTIONAL);
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 140);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 1400.0);
+
+    // A replacement that trades is filled like any other order.
+    LimitOrder ask(50, 30, 11.0, OrderSide::SELL);
+    book.addOrder(ask);
+    EXPECT_EQ(gate.amend(book, 1, 130, 11.0, 1, 0).size(), 1u);
+    EXPECT_EQ(exposure->position, 30);
+    EXPECT_EQ(exposure->openBuyQuantity, 100);
+    EXPECT_DOUBLE_EQ(exposure->openNotional, 1100.0);
+
+    gate.amend(book, 1, 50, 11.0, 1, 0);
+    EXPECT_EQ(exposure->openBuyQuantity, 50);
+    EXPECT_EQ(gate.trackedOrderCount(), 1u);
+
+    // Another account can neither reduce nor replace the order.
+    gate.amend(book, 1, 40, 11.0, 2, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::ACCOUNT_MISMATCH);
+    gate.amend(book, 1, 60, 12.0, 2, 0, &reject);
+    EXPECT_EQ(reject, RiskReject::ACCOUNT_MISMATCH);
+    EXPECT_EQ(book.getOrder(1)->getQuantity(), 50);
+    EXPECT_EQ(exposure->openBuyQuantity, 50);
+    EXPECT_EQ(gate.exposure(2), nullptr);
+}
+
+// Test that risk exposure follows orders queued in a batch auction
+TEST(RiskGateTests, FollowsOrdersThroughABatch) {
+    Orderbook book;
+    BatchConfig config;
+    config.maxOrders = 2;
+    book.setBatchMode(config);
+    RiskGate gate;
+
+    LimitOrder bid(1, 10, 10.0, OrderSide::BUY);
+    gate.submit(book, bid, 1, 0);
+    EXPECT_EQ(gate.exposure(1)->openBuyQuantity, 10);
+    // The second order completes the batch inside submit and fills both.
+    LimitOrder ask(2, 10, 10.0, OrderSide::SELL);
+    EXPECT_EQ(gate.submit(book, ask, 2, 0).size(), 1u);
+    EXPECT_EQ(gate.trackedOrderCount(), 0u);
+    EXPECT_EQ(gate.exposure(1)->position, 10);
+    EXPECT_EQ(gate.exposure(1)->openBuyQuantity, 0);
+    EXPECT_EQ(gate.exposure(2)->position, -10);
+
+    // An IOC order keeps its fills and loses the rest when its batch clears.
+    config.maxOrders = 3;
+    book.setBatchMode(config);
+    Order ioc(3, 10, 10.0, OrderType::LIMIT, OrderSide::BUY, DurationType::IMMEDIATE_OR_CANCEL);
+    LimitOrder partial(4, 4, 10.0, OrderSide::SELL);
+    LimitOrder bid2(5, 5, 9.0, OrderSide::BUY);
+    gate.submit(book, ioc, 1, 0);
+    gate.submit(book, partial, 2, 0);
+    EXPECT_EQ(gate.exposure(1)->openBuyQuantity, 10);
+    EXPECT_EQ(gate.submit(book, bid2, 3, 0).size(), 1u);
+    EXPECT_EQ(gate.exposure(1)->position, 14);
+    EXPECT_EQ(gate.exposure(1)->openBuyQuantity, 0);
+    EXPECT_DOUBLE_EQ(gate.exposure(1)->openNotional, 0.0);
+    EXPECT_EQ(gate.exposure(2)->position, -14);
+    EXPECT_EQ(gate.exposure(3)->openBuyQuantity, 5);
+    EXPECT_EQ(gate.trackedOrderCount(), 1u);
+
+    // The same when the clear comes from the clock rather than a submit.
+    config.maxOrders = 0;
+    config.interval = 1000;
+    book.setBatchMode(config);
+    EXPECT_TRUE(book.advanceClock(0).empty());
+    Order lateIoc(6, 8, 9.0, OrderType::LIMIT, OrderSide::SELL, DurationType::IMMEDIATE_OR_CANCEL);
+    gate.submit(book, lateIoc, 1, 0);
+    EXPECT_EQ(gate.exposure(1)->openSellQuantity, 8);
+    gate.onTrades(book.advanceClock(1000));
+    EXPECT_EQ(gate.exposure(1)->position, 9);
+    EXPECT_EQ(gate.exposure(1)->openSellQuantity, 0);
+    EXPECT_EQ(gate.exposure(3)->openBuyQuantity, 0);
+    EXPECT_EQ(gate.trackedOrderCount(), 0u);
+}
+
+// Test that the engine sends its personal orders through the risk gate
+TEST(RiskGateTests, EngineChecksPersonalOrders) {
+    TradingEngine engine;
+    RiskLimits limits;
+    limits.maxOrderQuantity = 50;
+    engine.riskGate_.setLimits(TradingEngine::PERSONAL_ACCOUNT, limits);
+
+    Order large(1, 100, 100.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED, true);
+    Order small(2, 50, 100.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED, true);
+    engine.processPersonalOrder(large);
+    engine.processPersonalOrder(small);
+    EXPECT_EQ(large.getStatus(), OrderStatus::CANCELLED);
+    EXPECT_EQ(small.getStatus(), OrderStatus::OPEN);
+    EXPECT_EQ(engine.orderbook_.getBidInterest(), 50);
+
+    Order sell(3, 20, 100.0, OrderType::LIMIT, OrderSide::SELL, DurationType::GOOD_TILL_CANCELLED, false);
+    engine.processOrder(sell);
+    EXPECT_EQ(engine.riskGate_.exposure(TradingEngine::PERSONAL_ACCOUNT)->position, 20);
+}
+
+// Test that the engine's rate limit runs on command time, not the wall clock
+TEST(RiskGateTests, EngineRateLimitFollowsCommandTime) {
+    TradingEngine engine;
+    RiskLimits limits;
+    limits.maxOrdersPerSecond = 1;
+    engine.riskGate_.setLimits(TradingEngine::PERSONAL_ACCOUNT, limits);
+    const Timestamp oneSecond = 1000000000;
+
+    OrderCommand command;
+    command.timestamp = 5 * oneSecond;
+    command.order = Order(1, 10, 90.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED);
+    engine.processCommand(command);
+    EXPECT_EQ(engine.clock_, 5 * oneSecond);
+
+    Order first(2, 10, 99.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED, true);
+    Order second(3, 10, 99.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED, true);
+    engine.processPersonalOrder(first);
+    engine.processPersonalOrder(second);
+    EXPECT_EQ(first.getStatus(), OrderStatus::OPEN);
+    EXPECT_EQ(second.getStatus(), OrderStatus::CANCELLED);
+
+    command.timestamp = 6 * oneSecond;
+    command.order = Order(4, 10, 90.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED);
+    engine.processCommand(command);
+    Order third(5, 10, 99.0, OrderType::LIMIT, OrderSide::BUY, DurationType::GOOD_TILL_CANCELLED, true);
+    engine.processPersonalOrder(third);
+    EXPECT_EQ(third.getStatus(), OrderStatus::OPEN);
+}
+
 // Test to see if we can Parse a single order from csv
 TEST(CSVParseTests, ParseSingleOrder) {
     CSVParse parser;
@@ -353,6 +1530,125 @@ TEST(CSVParseTests, ParseMultipleOrders) {
     EXPECT_EQ(order2.getSide(), OrderSide::BUY);
 }
 
+// Test that the streaming iterator yields the same orders, in file order
+TEST(CSVParseTests, MappedIteratorMatchesParse) {
+    MappedCSVParse parser("parse_multiple.csv");
+    std::vector<Order> streamed(parser.begin(), parser.end());
+
+    ASSERT_EQ(streamed.size(), 10);
+    EXPECT_EQ(streamed[2].getOrderId(), 3);
+    EXPECT_EQ(streamed[2].getQuantity(), 20);
+    EXPECT_DOUBLE_EQ(streamed[2].getPrice(), 97.5);
+    EXPECT_EQ(streamed[2].getType(), OrderType::LIMIT);
+    EXPECT_EQ(streamed[9].getOrderId(), 10);
+    EXPECT_EQ(streamed[9].getSide(), OrderSide::SELL);
+}
+
+// Test that parallel parsing hands chunks back in file order
+TEST(CSVParseTests, ParallelParseKeepsFileOrder) {
+    MappedCSVParse parser("parse_multiple.csv");
+    std::vector<OrderID> ids;
+    // Tiny chunks force one line per chunk across several threads
+    parser.parseOrdersParallel(4, [&](std::vector<Order>& chunk) {
+        for (const Order& order : chunk) {
+            ids.push_back(order.getOrderId());
+        }
+    }, 1);
+
+    ASSERT_EQ(ids.size(), 10);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(ids[i], i + 1);
+    }
+}
+
+// Test that a malformed line is rejected
+TEST(CSVParseTests, MappedParseRejectsShortLine) {
+    Order order;
+    EXPECT_FALSE(MappedCSVParse::parseLine("1,5,100.0,OrderType::LIMIT", order));
+    EXPECT_TRUE(MappedCSVParse::parseLine("1,5,100.0,OrderType::LIMIT,OrderSide::BUY,DurationType::FILL_OR_KILL", order));
+    EXPECT_EQ(order.getDuration(), DurationType::FILL_OR_KILL);
+}
+
+// Test that converting CSV to the binary format and mapping it back round-trips
+TEST(BinaryOrderFileTests, ConvertAndReadBack) {
+    std::string binaryName = "parse_multiple.bin";
+    EXPECT_EQ(convertCSVToBinary("parse_multiple.csv", binaryName, 0.01), 10);
+
+    {
+        BinaryOrderFile file(binaryName);
+        ASSERT_EQ(file.size(), 10);
+        EXPECT_DOUBLE_EQ(file.tickSize(), 0.01);
+        EXPECT_EQ(file[2].priceTicks, 9750);
+
+        Order order = file.toOrder(file[2]);
+        EXPECT_EQ(order.getOrderId(), 3);
+        EXPECT_EQ(order.getQuantity(), 20);
+        EXPECT_DOUBLE_EQ(order.getPrice(), 97.5);
+        EXPECT_EQ(order.getType(), OrderType::LIMIT);
+        EXPECT_EQ(order.getSide(), OrderSide::BUY);
+    }
+    std::remove(binaryName.c_str());
+}
+
+// Test that a CSV file and its binary conversion load to identical books
+TEST(BinaryOrderFileTests, LoadsTheSameBookAsTheCsv) {
+    std::string csvName = "cent_prices.csv";
+    std::string binaryName = "cent_prices.bin";
+    {
+        std::ofstream csv(csvName);
+        csv << "1,5,1.15,OrderType::LIMIT,OrderSide::BUY,DurationType::GOOD_TILL_CANCELLED\n"
+            << "2,7,1.13,OrderType::LIMIT,OrderSide::BUY,DurationType::GOOD_TILL_CANCELLED\n"
+            << "3,4,0.07,OrderType::LIMIT,OrderSide::BUY,DurationType::GOOD_TILL_CANCELLED\n"
+            << "4,6,4.35,OrderType::LIMIT,OrderSide::SELL,DurationType::GOOD_TILL_CANCELLED\n"
+            << "5,3,97.53,OrderType::LIMIT,OrderSide::SELL,DurationType::GOOD_TILL_CANCELLED\n"
+            << "6,2,1.15,OrderType::LIMIT,OrderSide::SELL,DurationType::GOOD_TILL_CANCELLED\n";
+    }
+    ASSERT_EQ(convertCSVToBinary(csvName, binaryName, 0.01), 6u);
+
+    Orderbook fromCsv;
+    for (Order order : MappedCSVParse(csvName)) {
+        fromCsv.addOrder(order);
+    }
+    Orderbook fromBinary;
+    {
+        BinaryOrderFile file(binaryName);
+        for (const BinaryOrderRecord& record : file) {
+            Order order = file.toOrder(record);
+            fromBinary.addOrder(order);
+        }
+    }
+
+    auto levels = [](const auto& side) {
+        std::vector<std::pair<Price, Quantity>> out;
+        for (const auto& [price, level] : side) {
+            out.emplace_back(price, level.totalQuantity());
+        }
+        return out;
+    };
+    EXPECT_EQ(levels(fromBinary.getBids()), levels(fromCsv.getBids()));
+    EXPECT_EQ(levels(fromBinary.getAsks()), levels(fromCsv.getAsks()));
+    EXPECT_EQ(fromBinary.getHighestBid(), 1.15);
+    std::remove(csvName.c_str());
+    std::remove(binaryName.c_str());
+}
+
+// Test that a record count whose byte size wraps around is still caught as truncated
+TEST(BinaryOrderFileTests, RejectsOverflowingRecordCount) {
+    std::string binaryName = "overflow_count.bin";
+    BinaryOrderFileHeader header{};
+    std::memcpy(header.magic, "OBKF", 4);
+    header.version = BINARY_ORDER_FILE_VERSION;
+    header.recordCount = std::numeric_limits<std::uint64_t>::max() / sizeof(BinaryOrderRecord) + 1;
+    BinaryOrderRecord record{};
+    {
+        std::ofstream out(binaryName, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    EXPECT_THROW(BinaryOrderFile file(binaryName), std::runtime_error);
+    std::remove(binaryName.c_str());
+}
+
 
 TEST(RandomGeneratorTests, GeneratorCorrectCount) {
     Orderbook book;
@@ -415,6 +1711,84 @@ TEST(RandomGeneratorTests, GeneratorMidPriceChangesFixedRange) {
         EXPECT_NE(0, midPrice-price); // check that the price changes every time
     }
 }
+// Test that generators with the same seed produce identical orders
+TEST(RandomGeneratorTests, GeneratorSeedIsReproducible) {
+    Orderbook book;
+    OrderGenerator first(book, 42);
+    OrderGenerator second(book, 42);
+    OrderGenerator otherStream(book, 42, 1);
+    OrderID firstID = 1, secondID = 1, otherID = 1;
+
+    std::vector<Order> a = first.generateOrders(50, firstID);
+    std::vector<Order> b = second.generateOrders(50, secondID);
+    std::vector<Order> c = otherStream.generateOrders(50, otherID);
+
+    bool streamsDiffer = false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].getPrice(), b[i].getPrice());
+        EXPECT_EQ(a[i].getQuantity(), b[i].getQuantity());
+        EXPECT_EQ(a[i].getSide(), b[i].getSide());
+        streamsDiffer |= a[i].getPrice() != c[i].getPrice() || a[i].getQuantity() != c[i].getQuantity();
+    }
+    EXPECT_TRUE(streamsDiffer);
+}
+
+// Test that generateInto fills the caller's buffer and advances the IDs
+TEST(RandomGeneratorTests, GenerateIntoFillsBuffer) {
+    Orderbook book;
+    OrderGenerator order_generator(book);
+    std::vector<Order> buffer(16);
+    OrderID nextOrderID = 100;
+
+    order_generator.generateInto(buffer.data(), buffer.size(), nextOrderID);
+
+    EXPECT_EQ(nextOrderID, 116);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        EXPECT_EQ(buffer[i].getOrderId(), 100 + i);
+        EXPECT_GE(buffer[i].getQuantity(), 1);
+        EXPECT_LE(buffer[i].getQuantity(), 100);
+    }
+}
+// Test that a workload reaches its cancel/amend mix and only targets issued IDs
+TEST(WorkloadGeneratorTests, CommandMixAndTargets) {
+    WorkloadConfig config;
+    config.minLiveOrders = 100;
+    WorkloadGenerator generator(config);
+    std::vector<OrderCommand> commands = generator.generate(20000);
+
+    OrderID maxIssued = 0;
+    size_t cancels = 0, amends = 0;
+    Timestamp lastTimestamp = 0;
+    for (const OrderCommand& command : commands) {
+        EXPECT_GE(command.timestamp, lastTimestamp);
+        lastTimestamp = command.timestamp;
+        if (command.type == CommandType::NEW) {
+            EXPECT_GT(command.order.getOrderId(), maxIssued);
+            maxIssued = command.order.getOrderId();
+            EXPECT_GE(command.order.getQuantity(), config.minSize);
+            EXPECT_LE(command.order.getQuantity(), config.maxSize);
+        } else {
+            EXPECT_LE(command.order.getOrderId(), maxIssued);
+            (command.type == CommandType::CANCEL ? cancels : amends)++;
+        }
+    }
+    EXPECT_GT(cancels + amends, commands.size() * 3 / 4);
+    EXPECT_GT(amends, cancels);
+}
+
+// Test that the same seed replays the same workload through a book
+TEST(WorkloadGeneratorTests, ReplayIsReproducible) {
+    auto run = []() {
+        WorkloadGenerator generator;
+        Orderbook book;
+        size_t trades = 0;
+        for (OrderCommand& command : generator.generate(5000)) {
+            trades += applyCommand(book, command).size();
+        }
+        return std::make_pair(trades, book.getBidInterest());
+    };
+    EXPECT_EQ(run(), run());
+}
 
 TEST(TradingEngineTests, TradingEngineInitTest) {
     TradingEngine my_engine;
@@ -473,6 +1847,75 @@ TEST(TradingEngineTests, TradingEngineNextOrderIDIncrement) {
     EXPECT_EQ(my_engine.nextOrderID_, initialOrderID + 5);
 }
 
+// Test that a full NDJSON order line maps onto every Order field
+TEST(OrderJsonTests, ParseFullOrder) {
+    Order order;
+    bool ok = parseOrderJson("{ \"orderId\": 42, \"price\": 100.25, \"quantity\": 7, \"side\": \"SELL\", "
+                             "\"type\": \"MARKET\", \"duration\": \"FILL_OR_KILL\", \"isPersonalOrder\": true }", order);
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(order.getOrderId(), 42);
+    EXPECT_DOUBLE_EQ(order.getPrice(), 100.25);
+    EXPECT_EQ(order.getQuantity(), 7);
+    EXPECT_EQ(order.getSide(), OrderSide::SELL);
+    EXPECT_EQ(order.getType(), OrderType::MARKET);
+    EXPECT_EQ(order.getDuration(), DurationType::FILL_OR_KILL);
+    EXPECT_EQ(order.getIsPersonalOrder(), true);
+}
+
+// Test that lines missing required fields are rejected
+TEST(OrderJsonTests, RejectsMalformedOrder) {
+    Order order;
+    EXPECT_FALSE(parseOrderJson("{\"orderId\":1,\"price\":100.0}", order));
+    EXPECT_FALSE(parseOrderJson("{\"orderId\":1,\"price\":\"abc\",\"quantity\":5}", order));
+    EXPECT_FALSE(parseOrderJson("not json", order));
+}
+
+// Test that binary NEW messages with out-of-range fields are refused
+TEST(BinaryProtocolTests, ValidatesNewOrderFields) {
+    binary::NewOrderMessage msg{};
+    msg.msgType = binary::MessageType::NEW_ORDER;
+    msg.side = static_cast<std::uint8_t>(OrderSide::SELL);
+    msg.type = static_cast<std::uint8_t>(OrderType::LIMIT);
+    msg.duration = static_cast<std::uint8_t>(DurationType::FILL_OR_KILL);
+    msg.orderId = 9;
+    msg.quantity = 10;
+    msg.price = 100.0;
+    EXPECT_TRUE(binary::isValid(msg));
+    EXPECT_EQ(binary::toOrder(msg).getDuration(), DurationType::FILL_OR_KILL);
+
+    binary::NewOrderMessage bad = msg;
+    bad.side = 2;
+    EXPECT_FALSE(binary::isValid(bad));
+    bad = msg;
+    bad.type = 0xFF;
+    EXPECT_FALSE(binary::isValid(bad));
+    bad = msg;
+    bad.duration = 3;
+    EXPECT_FALSE(binary::isValid(bad));
+    bad = msg;
+    bad.quantity = 0;
+    EXPECT_FALSE(binary::isValid(bad));
+}
+
+// Test that every value lands in a bucket whose lower bound is within 1/16 of it
+TEST(LatencyProbeTests, HistogramBucketsAreTight) {
+    for (std::uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL, ~0ULL}) {
+        std::size_t bucket = LogLinearHistogram::bucketFor(value);
+        ASSERT_LT(bucket, static_cast<std::size_t>(LogLinearHistogram::BUCKETS));
+        std::uint64_t lower = LogLinearHistogram::bucketLowerBound(bucket);
+        EXPECT_LE(lower, value);
+        EXPECT_LE(value - lower, lower / 16);
+        EXPECT_EQ(LogLinearHistogram::bucketFor(lower), bucket);
+    }
+
+    LogLinearHistogram histogram;
+    histogram.record(100);
+    histogram.record(100);
+    histogram.record(5000);
+    EXPECT_EQ(histogram.count(LogLinearHistogram::bucketFor(100)), 2);
+    EXPECT_EQ(histogram.max(), 5000);
+}
+
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);